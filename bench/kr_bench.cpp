@@ -0,0 +1,416 @@
+// Self-contained throughput benchmark. Sweeps window type and layout,
+// rolling mode, window size, input entropy and input size; every
+// configuration is run repeatedly and reported with its median. Optionally
+// reads cycles, instructions and cache misses via perf_event_open.
+//
+//   kr_bench [--format=csv|json] [--runs=N] [--sizes=MiB,...]
+//            [--taus=n,...] [--entropy=random,acgt,zero] [--filter=text]
+//            [--counters] [--input=path]
+//
+// --input replaces the generated inputs by a file (sizes and entropy are
+// ignored). --filter restricts the run to configurations whose name (e.g.
+// "61-full-roll") contains the text.
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/kr-bulk.hpp"
+#include "../include/kr-mmap.hpp"
+#include "../include/kr-window-handle.hpp"
+
+using namespace kr_fingerprinting;
+
+namespace {
+
+// Hardware counters of the calling thread, grouped such that all of them
+// cover the same interval. If the kernel or the permissions do not allow
+// perf_event_open, available() is false and all counts are 0.
+class perf_counters {
+ public:
+  constexpr static uint64_t count = 3;
+  constexpr static char const *names[count] = {"cycles", "instructions",
+                                               "cache_misses"};
+
+ private:
+  int fds_[count] = {-1, -1, -1};
+
+  static int open(uint64_t const config, int const group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return ::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+  }
+
+ public:
+  perf_counters() {
+    uint64_t const configs[count] = {PERF_COUNT_HW_CPU_CYCLES,
+                                     PERF_COUNT_HW_INSTRUCTIONS,
+                                     PERF_COUNT_HW_CACHE_MISSES};
+    for (uint64_t i = 0; i < count; ++i) {
+      fds_[i] = open(configs[i], fds_[0]);
+      if (fds_[i] < 0) {
+        close();
+        return;
+      }
+    }
+  }
+
+  perf_counters(perf_counters const &) = delete;
+  perf_counters &operator=(perf_counters const &) = delete;
+  ~perf_counters() { close(); }
+
+  void close() {
+    for (int &fd : fds_) {
+      if (fd >= 0) ::close(fd);
+      fd = -1;
+    }
+  }
+
+  bool available() const { return fds_[0] >= 0; }
+
+  void start() {
+    if (!available()) return;
+    ::ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  std::vector<uint64_t> stop() {
+    std::vector<uint64_t> result(count, 0);
+    if (!available()) return result;
+    ::ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t values[1 + count] = {};
+    if (::read(fds_[0], values, sizeof(values)) == sizeof(values)) {
+      std::copy(values + 1, values + 1 + count, result.begin());
+    }
+    return result;
+  }
+};
+
+struct options {
+  std::string format = "csv";
+  uint64_t runs = 5;
+  std::vector<uint64_t> sizes = {16};
+  // small, typical, larger than L1, and popping bytes from beyond L2
+  std::vector<uint64_t> taus = {8, 64, 4096, 4 << 20};
+  std::vector<std::string> entropies = {"random", "acgt"};
+  std::string filter;
+  std::string input;
+  bool counters = false;
+};
+
+struct result {
+  std::string name;
+  uint64_t bits;
+  std::string layout;
+  std::string mode;
+  uint64_t tau;
+  std::string entropy;
+  uint64_t size;
+  uint64_t runs;
+  uint64_t median_ns;
+  uint64_t min_ns;
+  std::vector<uint64_t> counters;  // medians, empty without --counters
+};
+
+template <typename T>
+T median(std::vector<T> v) {
+  std::sort(v.begin(), v.end());
+  return v[v.size() / 2];
+}
+
+// keeps the compiler from dropping the benchmarked loops
+uint64_t volatile sink;
+
+template <typename fingerprint_type>
+void consume(fingerprint_type const &fp) {
+  uint64_t w;
+  std::memcpy(&w, &fp, sizeof(w));
+  sink = sink + w;
+}
+
+std::vector<uint8_t> generate(std::string const &entropy, uint64_t const n) {
+  std::vector<uint8_t> text(n);
+  std::mt19937_64 g(10);
+  if (entropy == "random") {
+    for (auto &c : text) c = g();
+  } else if (entropy == "acgt") {
+    constexpr uint8_t acgt[4] = {'A', 'C', 'G', 'T'};
+    for (auto &c : text) c = acgt[g() & 3];
+  } else if (entropy != "zero") {
+    throw std::invalid_argument("unknown entropy: " + entropy);
+  }
+  return text;
+}
+
+template <typename window_type>
+void roll(window_type const &w, std::span<uint8_t const> const text) {
+  uint64_t const tau = w.window_size();
+  auto fp = typename window_type::fingerprint_type();
+  for (uint64_t i = 0; i < tau; ++i) fp = w.roll_right(fp, text[i]);
+  for (uint64_t i = 0; i < text.size() - tau; ++i) {
+    fp = w.roll_right(fp, text[i], text[i + tau]);
+  }
+  consume(fp);
+}
+
+template <typename window_type>
+void roll_lazy(window_type const &w, std::span<uint8_t const> const text) {
+  uint64_t const tau = w.window_size();
+  auto fp = typename window_type::fingerprint_type();
+  for (uint64_t i = 0; i < tau; ++i) fp = w.roll_right_lazy(fp, text[i]);
+  for (uint64_t i = 0; i < text.size() - tau; ++i) {
+    fp = w.roll_right_lazy(fp, text[i], text[i + tau]);
+  }
+  consume(w.canonicalize(fp));
+}
+
+template <typename window_type>
+void bulk(window_type const &w, std::span<uint8_t const> const text,
+          std::vector<typename window_type::fingerprint_type> &out) {
+  uint64_t const tau = w.window_size();
+  uint64_t const block = out.size();
+  for (uint64_t i = 0; i + tau <= text.size(); i += block) {
+    uint64_t const len = std::min(block + tau - 1, text.size() - i);
+    fingerprint_windows(w, text.subspan(i, len),
+                        std::span<typename window_type::fingerprint_type>(out));
+    consume(out[0]);
+  }
+}
+
+class runner {
+ private:
+  options const &opts_;
+  std::optional<perf_counters> counters_;
+  std::vector<result> results_;
+
+  result measure(std::function<void()> const &f) {
+    std::vector<uint64_t> times;
+    std::vector<std::vector<uint64_t>> counts(perf_counters::count);
+    f();  // warm-up: page faults, caches, branch predictors
+    for (uint64_t r = 0; r < opts_.runs; ++r) {
+      if (counters_) counters_->start();
+      auto const begin = std::chrono::steady_clock::now();
+      f();
+      auto const end = std::chrono::steady_clock::now();
+      if (counters_) {
+        auto const c = counters_->stop();
+        for (uint64_t i = 0; i < perf_counters::count; ++i) {
+          counts[i].push_back(c[i]);
+        }
+      }
+      times.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+              .count());
+    }
+    result res;
+    res.runs = opts_.runs;
+    res.median_ns = median(times);
+    res.min_ns = *std::min_element(times.begin(), times.end());
+    if (counters_) {
+      for (auto const &c : counts) res.counters.push_back(median(c));
+    }
+    return res;
+  }
+
+  template <uint64_t shift, table_layout layout>
+  void run_window(std::span<uint8_t const> const text, uint64_t const tau,
+                  std::string const &entropy) {
+    std::string const layout_name =
+        (layout == table_layout::full) ? "full" : "compact";
+    using window_type = sliding_window_handle<shift, layout>;
+    window_type const w(tau);
+    std::vector<typename window_type::fingerprint_type> out(1ULL << 16);
+
+    std::pair<std::string, std::function<void()>> const modes[] = {
+        {"roll", [&] { roll(w, text); }},
+        {"lazy", [&] { roll_lazy(w, text); }},
+        {"bulk", [&] { bulk(w, text, out); }},
+    };
+    for (auto const &[mode, f] : modes) {
+      std::string const name =
+          std::to_string(shift) + "-" + layout_name + "-" + mode;
+      if (name.find(opts_.filter) == std::string::npos) continue;
+      result res = measure(f);
+      res.name = name;
+      res.bits = shift;
+      res.layout = layout_name;
+      res.mode = mode;
+      res.tau = tau;
+      res.entropy = entropy;
+      res.size = text.size();
+      results_.push_back(std::move(res));
+      std::cerr << name << " tau=" << tau << " " << entropy << " "
+                << text.size() << ": " << results_.back().median_ns / 1e6
+                << " ms" << std::endl;
+    }
+  }
+
+  template <uint64_t shift>
+  void run_layouts(std::span<uint8_t const> const text, uint64_t const tau,
+                   std::string const &entropy) {
+    run_window<shift, table_layout::full>(text, tau, entropy);
+    run_window<shift, table_layout::compact>(text, tau, entropy);
+  }
+
+ public:
+  runner(options const &opts) : opts_(opts) {
+    if (opts_.counters) {
+      counters_.emplace();
+      if (!counters_->available()) {
+        std::cerr << "perf_event_open not available (see "
+                     "/proc/sys/kernel/perf_event_paranoid), counters "
+                     "disabled"
+                  << std::endl;
+        counters_.reset();
+      }
+    }
+  }
+
+  void run(std::span<uint8_t const> const text, std::string const &entropy) {
+    for (uint64_t const tau : opts_.taus) {
+      if (tau == 0 || tau >= text.size()) continue;
+      run_layouts<61>(text, tau, entropy);
+      run_layouts<122>(text, tau, entropy);
+      run_layouts<183>(text, tau, entropy);
+      run_layouts<244>(text, tau, entropy);
+      run_layouts<89>(text, tau, entropy);
+      run_layouts<107>(text, tau, entropy);
+      run_layouts<127>(text, tau, entropy);
+    }
+  }
+
+  void print(std::ostream &out) const {
+    bool const json = (opts_.format == "json");
+    bool const counters = counters_.has_value();
+    if (json) {
+      out << "[" << std::endl;
+    } else {
+      out << "name,bits,layout,mode,tau,entropy,size,runs,median_ns,min_ns,"
+             "mib_per_s";
+      if (counters) {
+        for (auto const *c : perf_counters::names) {
+          out << "," << c << "_per_byte";
+        }
+      }
+      out << std::endl;
+    }
+    for (uint64_t i = 0; i < results_.size(); ++i) {
+      result const &r = results_[i];
+      double const mibs = (r.size / 1048576.0) / (r.median_ns / 1e9);
+      if (json) {
+        out << "  {\"name\": \"" << r.name << "\", \"bits\": " << r.bits
+            << ", \"layout\": \"" << r.layout << "\", \"mode\": \"" << r.mode
+            << "\", \"tau\": " << r.tau << ", \"entropy\": \"" << r.entropy
+            << "\", \"size\": " << r.size << ", \"runs\": " << r.runs
+            << ", \"median_ns\": " << r.median_ns
+            << ", \"min_ns\": " << r.min_ns << ", \"mib_per_s\": " << mibs;
+        for (uint64_t c = 0; c < r.counters.size(); ++c) {
+          out << ", \"" << perf_counters::names[c]
+              << "_per_byte\": " << (double)r.counters[c] / r.size;
+        }
+        out << "}" << (i + 1 < results_.size() ? "," : "") << std::endl;
+      } else {
+        out << r.name << "," << r.bits << "," << r.layout << "," << r.mode
+            << "," << r.tau << "," << r.entropy << "," << r.size << ","
+            << r.runs << "," << r.median_ns << "," << r.min_ns << ","
+            << mibs;
+        for (uint64_t const c : r.counters) out << "," << (double)c / r.size;
+        out << std::endl;
+      }
+    }
+    if (json) out << "]" << std::endl;
+  }
+};
+
+std::vector<std::string> split(std::string const &s) {
+  std::vector<std::string> parts;
+  std::stringstream stream(s);
+  for (std::string part; std::getline(stream, part, ',');) {
+    if (!part.empty()) parts.push_back(part);
+  }
+  return parts;
+}
+
+std::vector<uint64_t> split_numbers(std::string const &s) {
+  std::vector<uint64_t> numbers;
+  for (auto const &part : split(s)) numbers.push_back(std::stoull(part));
+  return numbers;
+}
+
+options parse(int argc, char *argv[]) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    auto const value =
+        [&](std::string const &key) -> std::optional<std::string> {
+      if (arg.rfind(key + "=", 0) == 0) return arg.substr(key.size() + 1);
+      return std::nullopt;
+    };
+    if (auto v = value("--format")) {
+      opts.format = *v;
+    } else if (auto v = value("--runs")) {
+      opts.runs = std::max<uint64_t>(1, std::stoull(*v));
+    } else if (auto v = value("--sizes")) {
+      opts.sizes = split_numbers(*v);
+    } else if (auto v = value("--taus")) {
+      opts.taus = split_numbers(*v);
+    } else if (auto v = value("--entropy")) {
+      opts.entropies = split(*v);
+    } else if (auto v = value("--filter")) {
+      opts.filter = *v;
+    } else if (auto v = value("--input")) {
+      opts.input = *v;
+    } else if (arg == "--counters") {
+      opts.counters = true;
+    } else {
+      throw std::invalid_argument("unknown argument: " + arg);
+    }
+  }
+  if (opts.format != "csv" && opts.format != "json")
+    throw std::invalid_argument("unknown format: " + opts.format);
+  return opts;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  try {
+    options const opts = parse(argc, argv);
+    runner r(opts);
+    if (!opts.input.empty()) {
+      mapped_file const file(opts.input, true);
+      r.run(file.span(), "file");
+    } else {
+      for (auto const &entropy : opts.entropies) {
+        for (uint64_t const size : opts.sizes) {
+          auto const text = generate(entropy, size << 20);
+          r.run(text, entropy);
+        }
+      }
+    }
+    r.print(std::cout);
+  } catch (std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
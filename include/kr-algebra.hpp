@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+// Composition of fingerprints without touching the underlying bytes. With
+// fp(S) = sum S[k] * b^(|S| - 1 - k) (the fingerprint computed by the
+// windows), the fingerprint of a concatenation is
+//   fp(AB) = fp(A) * b^|B| + fp(B).
+// Powers b^l and b^-l for l <= cached_lengths are precomputed, longer
+// lengths fall back to fast exponentiation.
+template <typename window_type>
+class fingerprint_algebra {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  fingerprint_type const base_;
+  fingerprint_type const inverse_base_;
+
+  std::vector<fingerprint_type> powers_;
+  std::vector<fingerprint_type> inverse_powers_;
+
+ public:
+  fingerprint_algebra(window_type const &w, uint64_t const cached_lengths = 4096)
+      : base_(w.base()), inverse_base_(arith::inverse(base_)) {
+    powers_.resize(cached_lengths + 1);
+    inverse_powers_.resize(cached_lengths + 1);
+    powers_[0] = inverse_powers_[0] = arith::scalar(1);
+    for (uint64_t l = 1; l <= cached_lengths; ++l) {
+      powers_[l] = arith::mult(powers_[l - 1], base_);
+      inverse_powers_[l] = arith::mult(inverse_powers_[l - 1], inverse_base_);
+    }
+  }
+
+  // b^len
+  KRINLNFN fingerprint_type power(uint64_t const len) const {
+    if (len < powers_.size()) return powers_[len];
+    return arith::power(base_, len);
+  }
+
+  // b^-len
+  KRINLNFN fingerprint_type inverse_power(uint64_t const len) const {
+    if (len < inverse_powers_.size()) return inverse_powers_[len];
+    return arith::power(inverse_base_, len);
+  }
+
+  // fp(AB) from fp(A), fp(B) and |B|
+  KRINLNFN fingerprint_type concat(fingerprint_type const &fp_a,
+                                   fingerprint_type const &fp_b,
+                                   uint64_t const len_b) const {
+    return arith::mult_add(fp_a, power(len_b), fp_b);
+  }
+
+  // fp(B) from fp(AB), fp(A) and |B|
+  KRINLNFN fingerprint_type strip_prefix(fingerprint_type const &fp_ab,
+                                         fingerprint_type const &fp_a,
+                                         uint64_t const len_b) const {
+    return arith::sub(fp_ab, arith::mult(fp_a, power(len_b)));
+  }
+
+  // fp(A) from fp(AB), fp(B) and |B|
+  KRINLNFN fingerprint_type strip_suffix(fingerprint_type const &fp_ab,
+                                         fingerprint_type const &fp_b,
+                                         uint64_t const len_b) const {
+    return arith::mult(arith::sub(fp_ab, fp_b), inverse_power(len_b));
+  }
+
+  // fp(A^k) from fp(A) and |A|, by square-and-multiply on the pairs
+  // (fp(S), b^|S|) with (f, p) * (g, q) = (f * q + g, p * q). All factors are
+  // powers of A, so the order of concatenation does not matter.
+  fingerprint_type repeat(fingerprint_type const &fp_a, uint64_t const len_a,
+                          uint64_t k) const {
+    fingerprint_type result = fingerprint_type();
+    fingerprint_type square = fp_a;
+    fingerprint_type square_power = power(len_a);
+    while (k > 0) {
+      if (k & 1ULL) result = arith::mult_add(result, square_power, square);
+      square = arith::mult_add(square, square_power, square);
+      square_power = arith::mult(square_power, square_power);
+      k >>= 1;
+    }
+    return result;
+  }
+
+  inline fingerprint_type base() const { return base_; }
+  inline fingerprint_type inverse_base() const { return inverse_base_; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+// Modular arithmetic on fingerprints, for operations that go beyond rolling a
+// fixed window (substrings, concatenation, ...). A fingerprint is identified
+// by its type and the number of bits of its modulus (or moduli):
+//   uint64_t            mod 2^61 - 1
+//   kr_tuple::tuple<x>  lane-wise mod 2^61 - 1
+//   uint128_t           mod 2^bits - 1
+// All operations expect reduced operands.
+template <typename fingerprint_type, uint64_t bits>
+struct arithmetic;
+
+template <typename window_type>
+using window_arithmetic = arithmetic<typename window_type::fingerprint_type,
+                                     window_type::fingerprint_bits>;
+
+template <>
+struct arithmetic<uint64_t, 61> {
+  using fingerprint_type = uint64_t;
+  constexpr static uint64_t p = u64::p61;
+
+  KRINLNFN static uint64_t scalar(uint64_t const c) { return c; }
+
+  // low 64 bits of the fingerprint (of its first lane for tuples)
+  KRINLNFN static uint64_t word(uint64_t const a) { return a; }
+
+  // a * b + c
+  KRINLNFN static uint64_t mult_add(uint64_t const a, uint64_t const b,
+                                    uint64_t const c) {
+    return u64::mod(((uint128_t)a) * b + c);
+  }
+
+  KRINLNFN static uint64_t mult(uint64_t const a, uint64_t const b) {
+    return u64::mod(((uint128_t)a) * b);
+  }
+
+  KRINLNFN static uint64_t add(uint64_t const a, uint64_t const b) {
+    uint64_t const s = a + b;
+    return (s >= p) ? (s - p) : s;
+  }
+
+  KRINLNFN static uint64_t sub(uint64_t const a, uint64_t const b) {
+    return (a >= b) ? (a - b) : (a + p - b);
+  }
+
+  inline static uint64_t power(uint64_t const base, uint64_t const exponent) {
+    return u64::power(base, exponent);
+  }
+
+  // a^-1 = a^(p - 2), a != 0
+  inline static uint64_t inverse(uint64_t const a) {
+    return u64::power(a, p - 2);
+  }
+};
+
+template <uint64_t x>
+struct arithmetic<kr_tuple::tuple<x>, 61 * x> {
+  using fingerprint_type = kr_tuple::tuple<x>;
+  using lane = arithmetic<uint64_t, 61>;
+
+  KRINLNFN static fingerprint_type scalar(uint64_t const c) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = c;
+    return r;
+  }
+
+  KRINLNFN static uint64_t word(fingerprint_type const &a) { return a.v[0]; }
+
+  KRINLNFN static fingerprint_type mult_add(fingerprint_type const &a,
+                                            fingerprint_type const &b,
+                                            fingerprint_type const &c) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z)
+      r.v[z] = lane::mult_add(a.v[z], b.v[z], c.v[z]);
+    return r;
+  }
+
+  KRINLNFN static fingerprint_type mult(fingerprint_type const &a,
+                                        fingerprint_type const &b) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = lane::mult(a.v[z], b.v[z]);
+    return r;
+  }
+
+  KRINLNFN static fingerprint_type add(fingerprint_type const &a,
+                                       fingerprint_type const &b) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = lane::add(a.v[z], b.v[z]);
+    return r;
+  }
+
+  KRINLNFN static fingerprint_type sub(fingerprint_type const &a,
+                                       fingerprint_type const &b) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = lane::sub(a.v[z], b.v[z]);
+    return r;
+  }
+
+  inline static fingerprint_type power(fingerprint_type const &base,
+                                       uint64_t const exponent) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = lane::power(base.v[z], exponent);
+    return r;
+  }
+
+  inline static fingerprint_type inverse(fingerprint_type const &a) {
+    fingerprint_type r;
+    for (uint64_t z = 0; z < x; ++z) r.v[z] = lane::inverse(a.v[z]);
+    return r;
+  }
+};
+
+template <uint64_t bits>
+struct arithmetic<uint128_t, bits> {
+  using fingerprint_type = uint128_t;
+  constexpr static uint128_t p = (((uint128_t)1) << bits) - 1;
+
+  KRINLNFN static uint128_t scalar(uint64_t const c) { return c; }
+
+  KRINLNFN static uint64_t word(uint128_t const a) { return (uint64_t)a; }
+
+  KRINLNFN static uint128_t mult_add(uint128_t const a, uint128_t const b,
+                                     uint128_t const c) {
+    return u128::mult_add<p>(a, b, c);
+  }
+
+  KRINLNFN static uint128_t mult(uint128_t const a, uint128_t const b) {
+    return u128::mult<p>(a, b);
+  }
+
+  KRINLNFN static uint128_t add(uint128_t const a, uint128_t const b) {
+    uint128_t const s = a + b;
+    return (s >= p) ? (s - p) : s;
+  }
+
+  KRINLNFN static uint128_t sub(uint128_t const a, uint128_t const b) {
+    return (a >= b) ? (a - b) : (a + p - b);
+  }
+
+  inline static uint128_t power(uint128_t const base, uint64_t const exponent) {
+    return u128::power<p>(base, exponent);
+  }
+
+  // a^-1 = a^(p - 2), a != 0
+  inline static uint128_t inverse(uint128_t const a) {
+    return u128::power<p>(a, p - 2);
+  }
+};
+
+}  // namespace kr_fingerprinting
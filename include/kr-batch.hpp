@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+namespace batch {
+
+// Number of keys fingerprinted together, i.e. of independent chains per row.
+// The multi61 tuples multiply this by their number of lanes, the 128-bit
+// kernels need more registers per chain.
+template <typename fingerprint_type>
+constexpr static uint64_t default_keys = 8;
+
+template <>
+constexpr uint64_t default_keys<uint128_t> = 4;
+
+}  // namespace batch
+
+// Fingerprints many short independent keys (e.g. the keys of a key-value
+// store), `keys` at a time. A group of keys is transposed into a scratch
+// buffer of the caller: row j holds byte j of every key (structure of
+// arrays), right-aligned and padded with leading zeros, which do not change a
+// fingerprint. Every row then advances one chain per key, all with the same
+// base, so the multiply-reduce latencies of the keys overlap instead of
+// adding up. With KR_FINGERPRINTING_SIMD_LANES, the 61-bit lanes of four keys
+// are computed by one AVX2 kernel.
+// The fingerprints are the ones of pushing the bytes of a key with
+// roll_right(fp, c) into an empty window of the same base. Nothing is
+// allocated, the chains live on the stack and the scratch buffer can be
+// reused for every call. A group costs as many rows as its longest key, so
+// keys are grouped with keys of similar length.
+template <typename window_type,
+          uint64_t keys =
+              batch::default_keys<typename window_type::fingerprint_type>>
+class batch_fingerprinter {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t batch_size = keys;
+
+ private:
+  static_assert(keys > 0);
+  using arith = window_arithmetic<window_type>;
+
+  constexpr static bool p61_lanes =
+      !std::is_same_v<fingerprint_type, uint128_t>;
+  constexpr static uint64_t lanes =
+      p61_lanes ? sizeof(fingerprint_type) / sizeof(uint64_t) : 1;
+  using word_type = std::conditional_t<p61_lanes, uint64_t, uint128_t>;
+
+  fingerprint_type const base_;
+
+  KRINLNFN static word_type &lane(fingerprint_type &fp, uint64_t const z) {
+    if constexpr (std::is_same_v<fingerprint_type, uint64_t> ||
+                  std::is_same_v<fingerprint_type, uint128_t>) {
+      return fp;
+    } else {
+      return fp.v[z];
+    }
+  }
+
+  KRINLNFN static word_type lane(fingerprint_type const &fp,
+                                 uint64_t const z) {
+    return lane(const_cast<fingerprint_type &>(fp), z);
+  }
+
+  // fp[z][l] = fp[z][l] * b + row[l] for all rows, lane z of key l
+  KRINLNFN void advance(word_type (&fp)[lanes][keys], uint8_t const *block,
+                        uint64_t const rows) const {
+    if constexpr (p61_lanes) {
+#ifdef KR_FINGERPRINTING_AVX2
+      if constexpr (keys % 4 == 0) {
+        for (uint64_t z = 0; z < lanes; ++z) {
+          __m256i const b = _mm256_set1_epi64x(lane(base_, z));
+          __m256i v[keys / 4];
+          for (uint64_t g = 0; g < keys / 4; ++g) {
+            v[g] = _mm256_loadu_si256((__m256i const *)(fp[z] + 4 * g));
+          }
+          for (uint64_t r = 0; r < rows; ++r) {
+            uint8_t const *const row = block + r * keys;
+            for (uint64_t g = 0; g < keys / 4; ++g) {
+              int32_t c;
+              std::memcpy(&c, row + 4 * g, sizeof(c));
+              v[g] = u64::simd::mult_add(
+                  b, v[g], _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(c)));
+            }
+          }
+          for (uint64_t g = 0; g < keys / 4; ++g) {
+            _mm256_storeu_si256((__m256i *)(fp[z] + 4 * g), v[g]);
+          }
+        }
+        return;
+      }
+#endif
+      for (uint64_t r = 0; r < rows; ++r) {
+        uint8_t const *const row = block + r * keys;
+        for (uint64_t z = 0; z < lanes; ++z) {
+          uint64_t const b = lane(base_, z);
+          for (uint64_t l = 0; l < keys; ++l) {
+            if (b >= u64::p61 || fp[z][l] >= u64::p61)
+              __builtin_unreachable();
+            else
+              fp[z][l] = u64::mod(((uint128_t)b) * fp[z][l] + row[l]);
+          }
+        }
+      }
+    } else {
+      for (uint64_t r = 0; r < rows; ++r) {
+        uint8_t const *const row = block + r * keys;
+        for (uint64_t l = 0; l < keys; ++l) {
+          fp[0][l] = arith::mult_add(base_, fp[0][l], row[l]);
+        }
+      }
+    }
+  }
+
+  // out[idx[l]] = fingerprint of key(idx[l]) for l < count <= keys
+  template <typename K>
+  KRINLNFN void group(K const &key, uint64_t const *const idx,
+                      uint64_t const count, fingerprint_type *const out,
+                      std::span<uint8_t> const scratch) const {
+    std::span<uint8_t const> k[keys];
+    uint64_t max_length = 0;
+    for (uint64_t l = 0; l < count; ++l) {
+      k[l] = key(idx[l]);
+      max_length = std::max<uint64_t>(max_length, k[l].size());
+    }
+
+    // long keys are transposed and advanced in several passes
+    uint64_t const max_rows = scratch.size() / keys;
+    uint8_t *const block = scratch.data();
+    word_type fp[lanes][keys] = {};
+    for (uint64_t r0 = 0; r0 < max_length; r0 += max_rows) {
+      uint64_t const rows = std::min(max_rows, max_length - r0);
+      for (uint64_t l = 0; l < keys; ++l) {
+        // row j of key l holds k[l][j - pad], or 0 for j < pad
+        uint64_t const pad = max_length - k[l].size();
+        uint64_t r = 0;
+        for (; r < rows && r0 + r < pad; ++r) block[r * keys + l] = 0;
+        for (; r < rows; ++r) block[r * keys + l] = k[l][r0 + r - pad];
+      }
+      advance(fp, block, rows);
+    }
+
+    for (uint64_t l = 0; l < count; ++l) {
+      for (uint64_t z = 0; z < lanes; ++z) lane(out[idx[l]], z) = fp[z][l];
+    }
+  }
+
+  // Keys are grouped by length within windows of `groups` batches, which
+  // keeps the padding small for mixed lengths without reordering the output.
+  template <typename K>
+  inline void fingerprint_all(K const &key, uint64_t const n,
+                              fingerprint_type *const out,
+                              std::span<uint8_t> const scratch) const {
+    constexpr uint64_t groups = 8;
+    uint64_t idx[groups * keys];
+    for (uint64_t w = 0; w < n; w += groups * keys) {
+      uint64_t const m = std::min(groups * keys, n - w);
+      for (uint64_t i = 0; i < m; ++i) idx[i] = w + i;
+      std::sort(idx, idx + m, [&](uint64_t const a, uint64_t const b) {
+        return key(a).size() < key(b).size();
+      });
+      for (uint64_t i = 0; i < m; i += keys) {
+        group(key, idx + i, std::min(keys, m - i), out, scratch);
+      }
+    }
+  }
+
+  // a scratch buffer of less than `keys` bytes has room for no row
+  inline static void check_scratch(std::span<uint8_t> const scratch) {
+    if (scratch.size() < keys)
+      throw std::invalid_argument(
+          "batch_fingerprinter: the scratch buffer needs at least `keys` "
+          "bytes");
+  }
+
+ public:
+  batch_fingerprinter(window_type const &w) : base_(w.base()) {}
+
+  // Minimum size of the scratch buffer is `keys` bytes, fingerprint() throws
+  // std::invalid_argument for smaller buffers. Keys of up to
+  // max_length bytes are transposed in a single pass with this size.
+  constexpr static uint64_t scratch_size(uint64_t const max_length) {
+    return keys * std::max<uint64_t>(max_length, 1);
+  }
+
+  // out[i] = fingerprint of in[i], out must have room for |in| fingerprints
+  inline void fingerprint(std::span<std::span<uint8_t const> const> const in,
+                          std::span<fingerprint_type> const out,
+                          std::span<uint8_t> const scratch) const {
+    check_scratch(scratch);
+    fingerprint_all([&](uint64_t const i) { return in[i]; }, in.size(),
+                    out.data(), scratch);
+  }
+
+  // Keys stored back to back: key i is data[offsets[i], offsets[i + 1]).
+  // out must have room for |offsets| - 1 fingerprints.
+  inline void fingerprint(std::span<uint8_t const> const data,
+                          std::span<uint64_t const> const offsets,
+                          std::span<fingerprint_type> const out,
+                          std::span<uint8_t> const scratch) const {
+    check_scratch(scratch);
+    if (offsets.empty()) return;
+    fingerprint_all(
+        [&](uint64_t const i) {
+          return data.subspan(offsets[i], offsets[i + 1] - offsets[i]);
+        },
+        offsets.size() - 1, out.data(), scratch);
+  }
+
+  inline fingerprint_type base() const { return base_; }
+};
+
+}  // namespace kr_fingerprinting
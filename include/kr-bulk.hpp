@@ -0,0 +1,91 @@
+#pragma once
+
+#include <span>
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+namespace bulk {
+
+// Number of independent chains that fingerprint_windows advances in one loop.
+// A single chain is bound by the latency of multiply + reduce, interleaving
+// chains lets the core overlap them. The multi61 tuples already have x
+// independent lanes per roll, and the 128-bit kernels need more registers.
+// For all three 128-bit moduli, 2 chains measured faster than 1 (tau = 64);
+// mainp_bulk in kr_test.cpp reports both.
+template <typename fingerprint_type>
+constexpr static uint64_t default_chains = 4;
+
+template <uint64_t x>
+constexpr static uint64_t default_chains<kr_tuple::tuple<x>> =
+    (x >= 4) ? 1 : (4 / x);
+
+template <>
+constexpr uint64_t default_chains<uint128_t> = 2;
+
+template <uint64_t chains, typename window_type>
+KRINLNFN void fingerprint_windows(
+    window_type const &w, std::span<uint8_t const> const text,
+    std::span<typename window_type::fingerprint_type> const out) {
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+  uint64_t const tau = w.window_size();
+  uint64_t const windows = text.size() - tau + 1;
+  uint64_t const len = windows / chains;
+  uint8_t const *const t = text.data();
+  fingerprint_type *const o = out.data();
+
+  // chain k computes the windows starting at [k * len, (k + 1) * len),
+  // the last chain also computes the remaining windows
+  fingerprint_type fp[chains] = {};
+  for (uint64_t i = 0; i < tau; ++i) {
+    for (uint64_t k = 0; k < chains; ++k) {
+      fp[k] = w.roll_right(fp[k], t[k * len + i]);
+    }
+  }
+  for (uint64_t k = 0; k < chains; ++k) {
+    o[k * len] = window_type::canonicalize(fp[k]);
+  }
+  for (uint64_t j = 1; j < len; ++j) {
+    for (uint64_t k = 0; k < chains; ++k) {
+      uint64_t const i = k * len + j;
+      fp[k] = w.roll_right(fp[k], t[i - 1], t[i - 1 + tau]);
+      o[i] = window_type::canonicalize(fp[k]);
+    }
+  }
+  for (uint64_t i = chains * len; i < windows; ++i) {
+    fp[chains - 1] = w.roll_right(fp[chains - 1], t[i - 1], t[i - 1 + tau]);
+    o[i] = window_type::canonicalize(fp[chains - 1]);
+  }
+}
+
+}  // namespace bulk
+
+// out[i] = fingerprint of text[i, i + tau) for all i <= |text| - tau,
+// out must have room for |text| - tau + 1 fingerprints.
+// The text is split into segments that overlap by tau - 1 bytes, and the
+// segments are rolled as independent interleaved chains. The results are
+// the canonical fingerprints (see kr-hash.hpp) of rolling a single window
+// over the text: a chain seeds its first window from scratch, which may hold
+// 0 where the single window holds p.
+template <typename window_type,
+          uint64_t chains =
+              bulk::default_chains<typename window_type::fingerprint_type>>
+inline void fingerprint_windows(
+    window_type const &w, std::span<uint8_t const> const text,
+    std::span<typename window_type::fingerprint_type> const out) {
+  static_assert(chains > 0);
+  uint64_t const tau = w.window_size();
+  if (text.size() < tau) return;
+  uint64_t const windows = text.size() - tau + 1;
+
+  // every chain has to be seeded with tau bytes, which only pays off if the
+  // segments are considerably longer than the window
+  if (windows / chains >= 4 * tau + 1)
+    bulk::fingerprint_windows<chains>(w, text, out);
+  else
+    bulk::fingerprint_windows<1>(w, text, out);
+}
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <span>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+template <typename fingerprint_type>
+struct chunk {
+  uint64_t offset;
+  uint64_t length;
+  // fingerprint of the whole chunk
+  fingerprint_type fingerprint;
+};
+
+// Chunk size constraints. A position is a chunk boundary if the window
+// ending there satisfies (fp & mask) == mask, which happens with probability
+// 2^-popcount(mask) for the uniformly distributed residues.
+struct chunking_parameters {
+  uint64_t min_size;
+  uint64_t max_size;
+  uint64_t mask;
+
+  // mask = 2^k - 1 for the largest k with min_size + 2^k <= avg_size, the
+  // expected chunk size (ignoring max_size)
+  static chunking_parameters from_sizes(uint64_t const min_size,
+                                        uint64_t const avg_size,
+                                        uint64_t const max_size) {
+    uint64_t const gap = std::max<uint64_t>(avg_size, min_size + 1) - min_size;
+    return {min_size, max_size, std::bit_floor(gap) - 1};
+  }
+};
+
+// Content-defined chunking. Boundaries are found by rolling window_type
+// (usually sliding_window61) over the text; the rolling starts only
+// min_size bytes after the previous boundary. Every chunk is reported with
+// the fingerprint of its entire content, computed with the (stronger) base
+// of strong_window_type, e.g. one of the multi-lane windows.
+template <typename window_type, typename strong_window_type = window_type>
+class chunker {
+ public:
+  using strong_fingerprint_type = typename strong_window_type::fingerprint_type;
+  using chunk_type = chunk<strong_fingerprint_type>;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  window_type const &w_;
+  strong_window_type const &strong_;
+  uint64_t const min_size_;
+  uint64_t const max_size_;
+  uint64_t const mask_;
+
+  // end of the chunk that starts at s
+  KRINLNFN uint64_t boundary(uint8_t const *const t, uint64_t const s,
+                             uint64_t const n) const {
+    if (n - s <= min_size_) return n;
+    uint64_t const tau = w_.window_size();
+    uint64_t const end = std::min(n, s + max_size_);
+
+    // window [s + min_size - tau, s + min_size)
+    typename window_type::fingerprint_type fp{};
+    for (uint64_t i = s + min_size_ - tau; i < s + min_size_; ++i) {
+      fp = w_.roll_right(fp, t[i]);
+    }
+    if ((arith::word(fp) & mask_) == mask_) return s + min_size_;
+    for (uint64_t i = s + min_size_; i < end; ++i) {
+      fp = w_.roll_right(fp, t[i - tau], t[i]);
+      if ((arith::word(fp) & mask_) == mask_) return i + 1;
+    }
+    return end;
+  }
+
+ public:
+  // The windows are not copied and have to outlive the chunker. min_size is
+  // raised to the window size, max_size to min_size.
+  chunker(window_type const &w, strong_window_type const &strong,
+          chunking_parameters const &params)
+      : w_(w),
+        strong_(strong),
+        min_size_(std::max(params.min_size, w.window_size())),
+        max_size_(std::max(params.max_size, min_size_)),
+        mask_(params.mask) {}
+
+  // Calls f(chunk) for every chunk of the text in order, returns the number
+  // of chunks.
+  template <typename F>
+  uint64_t chunk_text(std::span<uint8_t const> const text, F const &f) const {
+    uint8_t const *const t = text.data();
+    uint64_t const n = text.size();
+    uint64_t chunks = 0;
+    for (uint64_t s = 0; s < n; ++chunks) {
+      uint64_t const e = boundary(t, s, n);
+      strong_fingerprint_type fp{};
+      for (uint64_t i = s; i < e; ++i) {
+        fp = strong_.roll_right(fp, t[i]);
+      }
+      f(chunk_type{s, e - s, fp});
+      s = e;
+    }
+    return chunks;
+  }
+
+  inline uint64_t min_size() const { return min_size_; }
+  inline uint64_t max_size() const { return max_size_; }
+  inline uint64_t mask() const { return mask_; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+#include "kr-hash.hpp"
+#include "kr-stream.hpp"
+
+namespace kr_fingerprinting {
+
+namespace delta {
+
+enum class op_type { copy, insert };
+
+// copy:   the bytes [offset, offset + length) of the base
+// insert: the bytes of data (length = |data|), which only stay valid during
+//         the callback; offset is their position in the new input
+struct op {
+  op_type type;
+  uint64_t offset;
+  uint64_t length;
+  std::span<uint8_t const> data;
+};
+
+// Strong hash of the blocks: a Karp-Rabin fingerprint modulo 2^127 - 1 with
+// its own random base, of the block read as little-endian 64-bit words (and
+// the remaining bytes). Two different blocks of length tau collide with
+// probability at most tau / 8 / 2^127. It is not a cryptographic hash.
+class strong_hash {
+  using arith = arithmetic<uint128_t, 127>;
+  uint128_t const base_;
+
+ public:
+  explicit strong_hash(uint128_t const base) : base_(base) {}
+
+  KRINLNFN uint128_t operator()(uint8_t const *const data,
+                                uint64_t const length) const {
+    uint128_t h = 0;
+    uint64_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, data + i, 8);
+      h = arith::mult_add(base_, h, word);
+    }
+    for (; i < length; ++i) h = arith::mult_add(base_, h, data[i]);
+    return h;
+  }
+
+  inline uint128_t base() const { return base_; }
+};
+
+// Fills buffer[0, size) from read, returns less than size only at the end of
+// the input.
+template <typename Reader>
+inline uint64_t read_full(Reader const &read, uint8_t *const buffer,
+                          uint64_t const size) {
+  uint64_t len = 0;
+  while (len < size) {
+    uint64_t const r = read(buffer + len, size - len);
+    if (r == 0) break;
+    len += r;
+  }
+  return len;
+}
+
+// Reads from a span in memory, like the readers of kr-stream.hpp.
+struct span_reader {
+  std::span<uint8_t const> mutable rest;
+
+  inline uint64_t operator()(uint8_t *const data, uint64_t const size) const {
+    uint64_t const r = std::min<uint64_t>(size, rest.size());
+    std::memcpy(data, rest.data(), r);
+    rest = rest.subspan(r);
+    return r;
+  }
+};
+
+}  // namespace delta
+
+// rsync-style delta encoding with blocks of the window size tau. sign()
+// splits the base into blocks and stores the window fingerprint (weak) and
+// the strong hash of every block; blocks equal to an earlier one are only
+// stored once, and a trailing partial block is not signed. encode() rolls
+// the windows over the new input, probes the flat signature table for every
+// window that is not covered by a copy, and confirms hits with the strong
+// hash of the window. As in pattern_matcher, the rolling runs `lookahead`
+// windows ahead of the probes and prefetches their groups. After a match
+// the scan skips the whole block. While a copy is open, the window right
+// after it is first compared with the next block of the base and extends
+// the copy (as rsync does), so runs of equal blocks, e.g. zero blocks,
+// become a single copy. Other adjacent copies are merged as well, and the
+// bytes between matches become inserts.
+// Both inputs are streamed through buffers of tau + block_size bytes. The
+// memory is that of the signatures, about 64 bytes plus one fingerprint per
+// block of the base, regardless of the size of the new input.
+template <typename window_type>
+class delta_encoder {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t lookahead = 8;
+  constexpr static uint64_t none = ~0ULL;
+
+ private:
+  window_type const &w_;
+  uint64_t const tau_;
+  delta::strong_hash const strong_;
+  // weak fingerprint -> first block; blocks with the same fingerprint (and
+  // different content) are chained in next_
+  flat_fingerprint_map<fingerprint_type, uint64_t> table_;
+  // weak (table key) and strong hash of every block
+  std::vector<fingerprint_type> keys_;
+  std::vector<uint128_t> strong_hashes_;
+  std::vector<uint64_t> next_;
+  uint64_t blocks_ = 0;
+  uint64_t distinct_ = 0;
+
+  KRINLNFN fingerprint_type fingerprint(uint8_t const *const data) const {
+    fingerprint_type fp = fingerprint_type();
+    for (uint64_t i = 0; i < tau_; ++i) fp = w_.roll_right(fp, data[i]);
+    return fp;
+  }
+
+  // canonical table keys, see kr-hash.hpp
+  KRINLNFN static fingerprint_type key(fingerprint_type const &fp) {
+    return window_type::canonicalize(fp);
+  }
+
+  // block of the base equal to the window, or none
+  KRINLNFN uint64_t lookup(fingerprint_type const &fp,
+                           uint8_t const *const window) const {
+    auto const *const slot = table_.find(fp);
+    if (slot == nullptr) [[likely]]
+      return none;
+    uint128_t const h = strong_(window, tau_);
+    for (uint64_t b = slot->value; b != none; b = next_[b]) {
+      if (strong_hashes_[b] == h) return b;
+    }
+    return none;
+  }
+
+  void add_block(uint8_t const *const data) {
+    uint64_t const b = blocks_++;
+    uint128_t const h = strong_(data, tau_);
+    fingerprint_type const k = key(fingerprint(data));
+    keys_.push_back(k);
+    strong_hashes_.push_back(h);
+    next_.push_back(none);
+    auto const [slot, inserted] = table_.insert(k, b);
+    if (!inserted) {
+      uint64_t last = slot->value;
+      while (strong_hashes_[last] != h && next_[last] != none) {
+        last = next_[last];
+      }
+      if (strong_hashes_[last] == h) return;
+      next_[last] = b;
+    }
+    ++distinct_;
+  }
+
+ public:
+  // The window is not copied and has to outlive the encoder. Signatures are
+  // only comparable between encoders with the same window (base) and the
+  // same strong base.
+  explicit delta_encoder(window_type const &w,
+                         uint128_t const strong_base = u128::random(
+                             1, arithmetic<uint128_t, 127>::p - 1))
+      : w_(w), tau_(w.window_size()), strong_(strong_base) {
+    if (tau_ == 0)
+      throw std::invalid_argument(
+          "delta_encoder: the window size must be positive");
+  }
+
+  // Signs the base produced by read(data, size) (see kr-stream.hpp), which
+  // replaces any previous base. Returns the number of signed blocks.
+  template <typename Reader>
+  uint64_t sign(Reader const &read,
+                uint64_t const block_size = stream::default_block_size) {
+    table_.clear();
+    keys_.clear();
+    strong_hashes_.clear();
+    next_.clear();
+    blocks_ = distinct_ = 0;
+
+    uint64_t const per_buffer = std::max<uint64_t>(block_size / tau_, 1);
+    std::vector<uint8_t> buffer(per_buffer * tau_);
+    while (true) {
+      uint64_t const len =
+          delta::read_full(read, buffer.data(), buffer.size());
+      for (uint64_t i = 0; i + tau_ <= len; i += tau_) {
+        add_block(buffer.data() + i);
+      }
+      if (len < buffer.size()) break;
+    }
+    return blocks_;
+  }
+
+  inline uint64_t sign(std::span<uint8_t const> const base) {
+    table_.reserve(base.size() / tau_);
+    return sign(delta::span_reader{base});
+  }
+
+  // Calls f(op) for the ops that rebuild the input produced by read(data,
+  // size) from the signed base, in order of the input. Returns the number
+  // of ops.
+  template <typename Reader, typename F>
+  uint64_t encode(Reader const &read, F const &f,
+                  uint64_t const block_size = stream::default_block_size) const {
+    constexpr uint64_t mask = lookahead - 1;
+    static_assert(std::has_single_bit(lookahead));
+
+    std::vector<uint8_t> buffer(tau_ + std::max(block_size, tau_));
+    uint8_t *const buf = buffer.data();
+    // buf[0, len) holds the input bytes [start, start + len)
+    uint64_t start = 0;
+    uint64_t len = 0;
+    // windows < ahead are rolled, windows >= j are not probed yet, the bytes
+    // < emitted are covered by ops
+    uint64_t ahead = 0;
+    uint64_t j = 0;
+    uint64_t emitted = 0;
+    bool end = false;
+    fingerprint_type ring[lookahead] = {};
+    fingerprint_type fp = fingerprint_type();
+
+    uint64_t ops = 0;
+    delta::op copy{delta::op_type::copy, 0, 0, {}};
+    auto flush_copy = [&]() {
+      if (copy.length == 0) return;
+      f(copy);
+      ++ops;
+      copy.length = 0;
+    };
+    // inserts the bytes [emitted, until)
+    auto flush_insert = [&](uint64_t const until) {
+      if (emitted >= until) return;
+      flush_copy();
+      f(delta::op{delta::op_type::insert, emitted, until - emitted,
+                  std::span<uint8_t const>(buf + (emitted - start),
+                                           until - emitted)});
+      ++ops;
+      emitted = until;
+    };
+
+    while (true) {
+      // windows whose bytes are in the buffer
+      uint64_t const available =
+          (start + len >= tau_) ? start + len - tau_ + 1 : 0;
+      for (; ahead < available && ahead < j + lookahead; ++ahead) {
+        if (ahead == 0) {
+          fp = fingerprint(buf);
+        } else {
+          fp = w_.roll_right(fp, buf[ahead - 1 - start],
+                             buf[ahead - 1 + tau_ - start]);
+        }
+        ring[ahead & mask] = key(fp);
+        if (ahead >= j) table_.prefetch(ring[ahead & mask]);
+      }
+
+      if (j >= ahead) {
+        if (end) break;
+        // keep the byte popped by the next roll, tau bytes unless the input
+        // is shorter than tau so far
+        uint64_t const keep = (ahead > 0) ? ahead - 1 : 0;
+        flush_insert(keep);
+        std::memmove(buf, buf + (keep - start), start + len - keep);
+        len -= keep - start;
+        start = keep;
+        uint64_t const r = read(buf + len, buffer.size() - len);
+        len += r;
+        end = (r == 0);
+        continue;
+      }
+
+      // the block after an open copy first, then any block
+      uint64_t const after = (copy.offset + copy.length) / tau_;
+      uint8_t const *const window = buf + (j - start);
+      uint64_t b = none;
+      if (copy.length > 0 && j == emitted && after < blocks_ &&
+          keys_[after] == ring[j & mask] &&
+          strong_(window, tau_) == strong_hashes_[after]) {
+        b = after;
+      } else {
+        b = lookup(ring[j & mask], window);
+      }
+      if (b == none) [[likely]] {
+        ++j;
+        continue;
+      }
+      flush_insert(j);
+      if (copy.length > 0 && copy.offset + copy.length == b * tau_) {
+        copy.length += tau_;
+      } else {
+        flush_copy();
+        copy.offset = b * tau_;
+        copy.length = tau_;
+      }
+      j += tau_;
+      emitted = j;
+    }
+    flush_insert(start + len);
+    flush_copy();
+    return ops;
+  }
+
+  template <typename F>
+  inline uint64_t encode(std::span<uint8_t const> const input,
+                         F const &f) const {
+    return encode(delta::span_reader{input}, f);
+  }
+
+  inline uint64_t blocks() const { return blocks_; }
+  // distinct signed blocks
+  inline uint64_t signatures() const { return distinct_; }
+  inline uint128_t strong_base() const { return strong_.base(); }
+  inline uint64_t window_size() const { return tau_; }
+};
+
+}  // namespace kr_fingerprinting
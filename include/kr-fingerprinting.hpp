@@ -33,23 +33,23 @@ fp_roll_function(sliding_window89)
 fp_roll_function(sliding_window107)
 fp_roll_function(sliding_window127)
 
-template <uint64_t shift>
+template <uint64_t shift, table_layout layout = table_layout::full>
 constexpr static auto shift_to_pointer_type() {
   if constexpr (shift == 61)
-    return (sliding_window61 *)0;
+    return (u64::basic_sliding_window61<layout> *)0;
   else if constexpr (shift == 122)
-    return (sliding_window122 *)0;
+    return (u64::sliding_window_multi61<2, layout> *)0;
   else if constexpr (shift == 183)
-    return (sliding_window183 *)0;
+    return (u64::sliding_window_multi61<3, layout> *)0;
   else if constexpr (shift == 244)
-    return (sliding_window244 *)0;
+    return (u64::sliding_window_multi61<4, layout> *)0;
 
   else if constexpr (shift == 89)
-    return (sliding_window89 *)0;
+    return (u128::sliding_windowX<89, layout> *)0;
   else if constexpr (shift == 107)
-    return (sliding_window107 *)0;
+    return (u128::sliding_windowX<107, layout> *)0;
   else if constexpr (shift == 127)
-    return (sliding_window127 *)0;
+    return (u128::sliding_windowX<127, layout> *)0;
 
   else {
     constexpr bool invalid_shift = false && shift;  // always false
@@ -64,16 +64,19 @@ constexpr static auto shift_to_pointer_type() {
   };
 }
 
-template <uint64_t shift>
+template <uint64_t shift, table_layout layout = table_layout::full>
 using shift_to_type =
-    std::remove_pointer_t<decltype(shift_to_pointer_type<shift>())>;
+    std::remove_pointer_t<decltype(shift_to_pointer_type<shift, layout>())>;
 
 template <uint64_t shift>
 constexpr static bool shift_supported =
     !std::is_same_v<shift_to_type<shift>, void>;
 
-template <uint64_t shift>
+template <uint64_t shift, table_layout layout = table_layout::full>
 using sliding_window =
-    std::enable_if_t<shift_supported<shift>, shift_to_type<shift>>;
+    std::enable_if_t<shift_supported<shift>, shift_to_type<shift, layout>>;
+
+template <uint64_t shift>
+using compact_sliding_window = sliding_window<shift, table_layout::compact>;
 
 }  // namespace kr_fingerprinting
@@ -26,9 +26,12 @@ inline constexpr uint128_t mod(uint128_t const value) {
 
 // this assumes a,b,c < modulus
 // a * b + c
+// Generic kernel on four 128-bit partial products, kept as the reference for
+// the specialized kernels below.
 template <uint128_t modulus>
-inline constexpr static uint128_t mult_add(uint128_t const a, uint128_t const b,
-                                           uint128_t const c) {
+inline constexpr static uint128_t mult_add_generic(uint128_t const a,
+                                                   uint128_t const b,
+                                                   uint128_t const c) {
   if (a >= modulus) __builtin_unreachable();
   if (b >= modulus) __builtin_unreachable();
   if (c >= modulus) __builtin_unreachable();
@@ -47,7 +50,6 @@ inline constexpr static uint128_t mult_add(uint128_t const a, uint128_t const b,
 
   if constexpr (shift < 127) {
     if (h >= modulus) __builtin_unreachable();
-    if (l >= modulus) __builtin_unreachable();
     if (m1 >= modulus) __builtin_unreachable();
     if (m2 >= modulus) __builtin_unreachable();
     // this only works because we have sufficiently many overflow bits
@@ -59,8 +61,10 @@ inline constexpr static uint128_t mult_add(uint128_t const a, uint128_t const b,
     return mod<modulus>(sum);
   } else {
     // for p127 the single overflow bit is not sufficient
-    uint128_t const carry =
-        ((l >> 64) + (c >> 64) + (uint64_t)m1 + (uint64_t)m2) >> 64;
+    uint128_t const low = ((uint128_t)(uint64_t)l) + (uint64_t)c;
+    uint128_t const carry = ((l >> 64) + (c >> 64) + (uint64_t)m1 +
+                             (uint64_t)m2 + (low >> 64)) >>
+                            64;
 
     uint128_t const h128 = h + (m1 >> 64) + (m2 >> 64) + carry;
     uint128_t const l128 = l + c + (m1 << 64) + (m2 << 64);
@@ -72,6 +76,103 @@ inline constexpr static uint128_t mult_add(uint128_t const a, uint128_t const b,
   }
 }
 
+// a * b + c for 64 < s < 127 as a value below 2^(s+2), not yet reduced, on
+// 64-bit limbs a = a1 * 2^64 + a0 (the compiler emits mul/mulx and adc for
+// the 64x64 -> 128 bit products and carries). With
+//   lo  = a0 * b0,  mid = a0 * b1 + a1 * b0,  hi = a1 * b1,
+//   t   = mid + (lo >> 64),
+// the product is hi * 2^128 + t * 2^64 + (lo mod 2^64), which is folded once
+// at bit s, using 2^s = 1 (mod 2^s - 1). Expects a < 2^s - 1 and
+// b, c < 2^s + 2^8, which covers the lazy range of mult_add_lazy.
+template <uint128_t modulus>
+KRINLNFN constexpr uint128_t mult_add_unreduced(uint128_t const a,
+                                                uint128_t const b,
+                                                uint128_t const c) {
+  constexpr uint64_t shift = popcount(modulus);
+  static_assert(64 < shift && shift < 127);
+  constexpr uint64_t top = shift - 64;  // bits of a1 and b1
+  uint64_t const a0 = (uint64_t)a;
+  uint64_t const a1 = (uint64_t)(a >> 64);
+  uint64_t const b0 = (uint64_t)b;
+  uint64_t const b1 = (uint64_t)(b >> 64);
+
+  uint128_t const lo = (uint128_t)a0 * b0;
+  uint128_t hi;
+  if constexpr (2 * top <= 64) {
+    // p89: a1 * b1 <= 2^50 is a single 64-bit multiplication
+    hi = (uint64_t)(a1 * b1);
+  } else {
+    hi = (uint128_t)a1 * b1;
+  }
+  // mid < 2^(s+1), so t does not overflow and t >> top + hi << (128 - s)
+  // stays below 2^s + 2^66
+  uint128_t const mid = (uint128_t)a0 * b1 + (uint128_t)a1 * b0;
+  uint128_t const t = mid + (lo >> 64);
+  constexpr uint128_t top_mask = (((uint128_t)1) << top) - 1;
+  uint128_t const low = (uint64_t)lo | ((t & top_mask) << 64);
+  uint128_t const high = (t >> top) + (hi << (128 - shift));
+  return low + high + c;
+}
+
+// a * b + c for a, b, c < modulus = 2^s - 1 with 64 < s <= 127, see
+// mult_add_unreduced
+template <uint128_t modulus>
+inline constexpr static uint128_t mult_add(uint128_t const a, uint128_t const b,
+                                           uint128_t const c) {
+  constexpr uint64_t shift = popcount(modulus);
+  if constexpr (shift <= 64) {
+    return mult_add_generic<modulus>(a, b, c);
+  } else {
+    if (a >= modulus) __builtin_unreachable();
+    if (b >= modulus) __builtin_unreachable();
+    if (c >= modulus) __builtin_unreachable();
+
+    if constexpr (shift < 127) {
+      return mod<modulus>(mult_add_unreduced<modulus>(a, b, c));
+    } else {
+      // p127: the same limbs, but t may carry into bit 128
+      constexpr uint64_t top = shift - 64;
+      uint64_t const a0 = (uint64_t)a;
+      uint64_t const a1 = (uint64_t)(a >> 64);
+      uint64_t const b0 = (uint64_t)b;
+      uint64_t const b1 = (uint64_t)(b >> 64);
+
+      uint128_t const lo = (uint128_t)a0 * b0;
+      uint128_t const hi = (uint128_t)a1 * b1;
+      uint128_t const mid = (uint128_t)a0 * b1 + (uint128_t)a1 * b0;
+      uint128_t const t = mid + (lo >> 64);
+      uint64_t const carry = t < mid;
+      constexpr uint128_t top_mask = (((uint128_t)1) << top) - 1;
+      uint128_t const low = (uint64_t)lo | ((t & top_mask) << 64);
+      // < 2^127 + 2^66
+      uint128_t const high =
+          (t >> top) + (((uint128_t)carry) << (128 - top)) + (hi << 1);
+      // low + c <= 2^128 - 2, folded to <= 2^127; high folded to < 2^127
+      uint128_t const x = ((low + c) & modulus) + ((low + c) >> shift);
+      uint128_t const y = (high & modulus) + (high >> shift);
+      return mod<modulus>(x + y);
+    }
+  }
+}
+
+// Lazy reduction: a * b + c congruent, in [0, 2^s + 4) instead of [0, p),
+// for a < p and b, c < 2^s + 2^8 (64 < s < 127). Saves the conditional
+// subtraction of mod. For p127 there is no room for a redundant range, this
+// is mult_add (and expects reduced operands).
+template <uint128_t modulus>
+KRINLNFN constexpr uint128_t mult_add_lazy(uint128_t const a,
+                                           uint128_t const b,
+                                           uint128_t const c) {
+  constexpr uint64_t shift = popcount(modulus);
+  if constexpr (64 < shift && shift < 127) {
+    if (a >= modulus) __builtin_unreachable();
+    uint128_t const x = mult_add_unreduced<modulus>(a, b, c);
+    return (x & modulus) + (x >> shift);
+  } else {
+    return mult_add<modulus>(a, b, c);
+  }
+}
+
 template <uint128_t modulus>
 inline constexpr static uint128_t mult(uint128_t const a, uint128_t const b) {
   return mult_add<modulus>(a, b, 0);
@@ -104,33 +205,69 @@ inline static uint128_t random(uint128_t min, uint128_t max) {
   return min + ((r > max) ? random(0, max) : r);
 }
 
-template <uint64_t shift>
+template <uint64_t shift, table_layout layout = table_layout::full>
 struct sliding_windowX {
  private:
   // mersenne prime 2^61 - 1
   constexpr static uint64_t s = shift;
   constexpr static uint128_t p = (((uint128_t)1) << s) - 1;
 
+  using table_type =
+      std::conditional_t<layout == table_layout::full, uint128_t[256][256],
+                         uint128_t[256]>;
+
   uint64_t const window_size_;
   uint128_t const base_;
 
-  uint128_t const table_[256][256] = {};
+  table_type const table_ = {};
 
   double const collision_rate_ = ((double)window_size_ - 1) / p;
 
- public:
-  using fingerprint_type = uint128_t;
-
-  sliding_windowX(uint64_t const window_size, uint128_t const base)
-      : window_size_(window_size), base_(u128::mod<p>(base)) {
+  // as in u64::basic_sliding_window61: the first column by one subtraction
+  // per row, the rows by conditional subtractions
+  void fill_table() {
     auto d = const_auto_cast(table_);
     uint128_t const max_exponent = u128::power<p>(base_, window_size_);
+    uint128_t first = 0;
     for (uint64_t i = 0; i < 256; ++i) {
-      d[i][0] = u128::mod<p>(p - u128::mult<p>(i, max_exponent));
-      for (uint64_t j = 1; j < 256; ++j) {
-        d[i][j] = u128::mod<p>(d[i][j - 1] + 1);
+      if constexpr (layout == table_layout::full) {
+        for (uint64_t j = 0; j < 256; ++j) {
+          uint128_t const v = first + j;
+          d[i][j] = (v >= p) ? (v - p) : v;
+        }
+      } else {
+        d[i] = first;
       }
+      first = (first >= max_exponent) ? (first - max_exponent)
+                                       : (first + p - max_exponent);
     }
+  }
+
+  table_io::header table_header() const {
+    return {table_io::magic, fingerprint_bits, (uint64_t)layout, window_size_,
+            sizeof(table_)};
+  }
+
+  // -b^tau, checked against loaded tables
+  uint128_t minus_power() const {
+    uint128_t const e = canonicalize(u128::power<p>(base_, window_size_));
+    return (e == 0) ? 0 : (p - e);
+  }
+
+ public:
+  using fingerprint_type = uint128_t;
+  constexpr static uint64_t fingerprint_bits = shift;
+
+  sliding_windowX(uint64_t const window_size, uint128_t const base)
+      : window_size_(window_size), base_(u128::mod<p>(base)) {
+    fill_table();
+  };
+
+  // loads the table written by save_table for the same window size and base
+  sliding_windowX(uint64_t const window_size, uint128_t const base,
+                  std::istream &table)
+      : window_size_(window_size), base_(u128::mod<p>(base)) {
+    table_io::load(table, table_header(), base_, table_, minus_power());
   };
 
   sliding_windowX(uint64_t const window_size)
@@ -139,11 +276,21 @@ struct sliding_windowX {
   template <ByteType T>
   inline uint128_t roll_right(uint128_t const fp, T const pop_left,
                               T const push_right) const {
-    auto lookup = table_[pop_left][push_right];
-    if (base_ >= p || fp >= p || lookup >= p)
-      __builtin_unreachable();
-    else
-      return u128::mult_add<p>(base_, fp, lookup);
+    if constexpr (layout == table_layout::full) {
+      auto lookup = table_[pop_left][push_right];
+      if (base_ >= p || fp >= p || lookup >= p)
+        __builtin_unreachable();
+      else
+        return u128::mult_add<p>(base_, fp, lookup);
+    } else {
+      // mult_add expects c < p, so the sum needs one conditional subtraction
+      auto lookup = table_[pop_left] + push_right;
+      lookup = (lookup >= p) ? (lookup - p) : lookup;
+      if (base_ >= p || fp >= p || lookup >= p)
+        __builtin_unreachable();
+      else
+        return u128::mult_add<p>(base_, fp, lookup);
+    }
   }
 
   template <ByteType T>
@@ -154,6 +301,37 @@ struct sliding_windowX {
     return u128::mult_add<p>(base_, fp, push_right);
   }
 
+  // Lazy reduction, see u128::mult_add_lazy: the fingerprints are kept in
+  // [0, 2^s + 4). The results are congruent to the ones of roll_right;
+  // canonicalize them before comparing, hashing or emitting them. For p127
+  // this is roll_right.
+  template <ByteType T>
+  KRINLNFN uint128_t roll_right_lazy(uint128_t const fp, T const pop_left,
+                                     T const push_right) const {
+    if constexpr (s == 127) {
+      return roll_right(fp, pop_left, push_right);
+    } else if constexpr (layout == table_layout::full) {
+      return u128::mult_add_lazy<p>(base_, fp, table_[pop_left][push_right]);
+    } else {
+      return u128::mult_add_lazy<p>(base_, fp, table_[pop_left] + push_right);
+    }
+  }
+
+  template <ByteType T>
+  KRINLNFN uint128_t roll_right_lazy(uint128_t const fp,
+                                     T const push_right) const {
+    return u128::mult_add_lazy<p>(base_, fp, push_right);
+  }
+
+  // the representative in [0, p) of fp, see kr-hash.hpp
+  KRINLNFN static uint128_t canonicalize(uint128_t const fp) {
+    return (fp >= p) ? (fp - p) : fp;
+  }
+
+  void save_table(std::ostream &out) const {
+    table_io::save(out, table_header(), base_, table_);
+  }
+
   inline uint128_t base() const { return base_; }
   inline uint64_t window_size() const { return window_size_; }
   inline uint64_t bits() const { return s; }
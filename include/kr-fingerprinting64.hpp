@@ -2,12 +2,24 @@
 
 #include <bit>
 #include <cstring>
+#include <istream>
 #include <limits>
+#include <ostream>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <type_traits>
 #include "tuple.hpp"
 
+// define KR_FINGERPRINTING_SIMD_LANES to compute the lanes of
+// sliding_window_multi61 with AVX2 instead of the scalar lane loop. The scalar
+// loop already overlaps the independent lanes, and the 32-bit limb kernel has
+// the longer dependency chain, so measure before enabling it.
+#if defined(__AVX2__) && defined(KR_FINGERPRINTING_SIMD_LANES)
+#include <immintrin.h>
+#define KR_FINGERPRINTING_AVX2
+#endif
+
 #define KRINLNFN __attribute__((always_inline)) inline
 
 namespace kr_fingerprinting {
@@ -22,6 +34,70 @@ inline T *const_auto_cast(T const *t) {
   return const_cast<T *>(t);
 }
 
+// Layout of the lookup table used by roll_right(fp, pop_left, push_right).
+// full:    table[c][d] = d - c * b^tau, one lookup per roll (256x256 entries)
+// compact: table[c] = -c * b^tau, push_right is added during the roll
+//          (256 entries, fits in L1 next to the actual working set)
+enum class table_layout { full, compact };
+
+// Table files: a header identifying the window, its base, and the raw table.
+// The format is host specific (endianness, object layout); it is meant for
+// caching the tables of deterministic seeds between runs, not for exchange.
+namespace table_io {
+
+constexpr uint64_t magic = 0x31454c4241544b52ULL;  // "KRTABLE1"
+
+struct header {
+  uint64_t magic;
+  uint64_t bits;
+  uint64_t layout;
+  uint64_t window_size;
+  uint64_t table_bytes;
+};
+
+template <typename fingerprint_type, typename table_type>
+inline void save(std::ostream &out, header const &h,
+                 fingerprint_type const &base, table_type const &table) {
+  out.write((char const *)&h, sizeof(h));
+  out.write((char const *)&base, sizeof(base));
+  out.write((char const *)&table, sizeof(table));
+  if (!out) throw std::runtime_error("kr_fingerprinting: cannot write table");
+}
+
+// the table entry for pop_left = c and push_right = 0, i.e. -c * b^tau
+template <typename table_type>
+inline auto const &first_column(table_type const &table, uint64_t const c) {
+  if constexpr (std::rank_v<table_type> == 2) {
+    return table[c][0];
+  } else {
+    return table[c];
+  }
+}
+
+// throws std::runtime_error unless the stream holds the table of exactly
+// this window (same bits, layout, window size and base); minus_power is
+// -b^tau, which has to be the loaded entry for pop_left = 1 (a cheap check
+// against corrupted files)
+template <typename fingerprint_type, typename table_type>
+inline void load(std::istream &in, header const &h,
+                 fingerprint_type const &base, table_type const &table,
+                 fingerprint_type const &minus_power) {
+  header file_header;
+  fingerprint_type file_base;
+  in.read((char *)&file_header, sizeof(file_header));
+  in.read((char *)&file_base, sizeof(file_base));
+  if (!in || std::memcmp(&file_header, &h, sizeof(h)) != 0 ||
+      std::memcmp(&file_base, &base, sizeof(base)) != 0)
+    throw std::runtime_error("kr_fingerprinting: table does not match window");
+  in.read((char *)const_auto_cast(&table), sizeof(table));
+  if (!in) throw std::runtime_error("kr_fingerprinting: truncated table");
+  if (std::memcmp(&first_column(table, 1), &minus_power,
+                  sizeof(minus_power)) != 0)
+    throw std::runtime_error("kr_fingerprinting: corrupted table");
+}
+
+}  // namespace table_io
+
 namespace u64 {
 
 constexpr uint64_t p61 = (1ULL << 61) - 1;
@@ -31,6 +107,104 @@ KRINLNFN constexpr uint64_t mod(uint128_t const value) {
   return (i & p61) + (i >> 61);
 }
 
+// Partial reduction of the lazy rolling mode: maps value < 2^125 to a
+// congruent value in [0, 2^64), using 2^64 = 8 (mod p61). A carry out of the
+// 64-bit addition is worth another 8 and cannot carry again.
+KRINLNFN constexpr uint64_t fold64(uint128_t const value) {
+  uint64_t const lo = (uint64_t)value;
+  uint64_t const hi = (uint64_t)(value >> 64);
+  uint64_t r;
+  bool const carry = __builtin_add_overflow(lo, hi << 3, &r);
+  return r + (carry ? 8 : 0);
+}
+
+// the residue in [0, p61) of any 64-bit value
+KRINLNFN constexpr uint64_t canonical(uint64_t const value) {
+  uint64_t const i = (value & p61) + (value >> 61);
+  return (i >= p61) ? (i - p61) : i;
+}
+
+#ifdef KR_FINGERPRINTING_AVX2
+namespace simd {
+
+// Four independent lanes of u64::mod(a * b + c) with a, b < 2^61 and
+// c < 2^62. AVX2 has no 64x64 multiplication, so the product is assembled
+// from 32-bit limbs:
+//   a * b + c = hh * 2^64 + m * 2^32 + ll + c
+//             = (8 * hh + (m >> 29) + (ll >> 61)) * 2^61
+//               + (ll & p61) + ((m & (2^29 - 1)) << 32) + c
+// which yields exactly (a * b + c) >> 61 and (a * b + c) & p61, so the two
+// folds below are bit-identical to the scalar u64::mod.
+KRINLNFN __m256i mult_add(__m256i const a, __m256i const b, __m256i const c) {
+  __m256i const mask61 = _mm256_set1_epi64x(p61);
+  __m256i const mask29 = _mm256_set1_epi64x((1ULL << 29) - 1);
+
+  __m256i const ah = _mm256_srli_epi64(a, 32);
+  __m256i const bh = _mm256_srli_epi64(b, 32);
+  __m256i const ll = _mm256_mul_epu32(a, b);
+  __m256i const hh = _mm256_mul_epu32(ah, bh);
+  __m256i const m =
+      _mm256_add_epi64(_mm256_mul_epu32(ah, b), _mm256_mul_epu32(a, bh));
+
+  __m256i lo = _mm256_add_epi64(
+      _mm256_add_epi64(_mm256_and_si256(ll, mask61),
+                       _mm256_slli_epi64(_mm256_and_si256(m, mask29), 32)),
+      c);
+  __m256i const hi = _mm256_add_epi64(
+      _mm256_add_epi64(_mm256_srli_epi64(ll, 61), _mm256_srli_epi64(m, 29)),
+      _mm256_add_epi64(_mm256_slli_epi64(hh, 3), _mm256_srli_epi64(lo, 61)));
+  lo = _mm256_and_si256(lo, mask61);
+
+  __m256i const i = _mm256_add_epi64(lo, hi);
+  return _mm256_add_epi64(_mm256_and_si256(i, mask61),
+                          _mm256_srli_epi64(i, 61));
+}
+
+// lanes [z, min(z + 4, x)) of a tuple
+template <uint64_t x, uint64_t z>
+KRINLNFN __m256i load(uint64_t const *v) {
+  if constexpr (x - z >= 4) {
+    return _mm256_loadu_si256((__m256i const *)(v + z));
+  } else {
+    // no masked load: it defeats store forwarding from the previous roll
+    return _mm256_set_epi64x(0, (x - z > 2) ? v[z + 2] : 0,
+                             (x - z > 1) ? v[z + 1] : 0, v[z]);
+  }
+}
+
+template <uint64_t x, uint64_t z>
+KRINLNFN void store(uint64_t *v, __m256i const value) {
+  if constexpr (x - z >= 4) {
+    _mm256_storeu_si256((__m256i *)(v + z), value);
+  } else {
+    v[z] = _mm256_extract_epi64(value, 0);
+    if constexpr (x - z > 1) v[z + 1] = _mm256_extract_epi64(value, 1);
+    if constexpr (x - z > 2) v[z + 2] = _mm256_extract_epi64(value, 2);
+  }
+}
+
+// fp.v[i] = u64::mod(base.v[i] * fp.v[i] + c.v[i] + add)
+template <uint64_t x, uint64_t z = 0>
+KRINLNFN void mult_add(kr_tuple::tuple<x> const &base, kr_tuple::tuple<x> &fp,
+                       kr_tuple::tuple<x> const &c, uint64_t const add) {
+  __m256i const sum = _mm256_add_epi64(load<x, z>(c.v),
+                                       _mm256_set1_epi64x(add));
+  store<x, z>(fp.v, mult_add(load<x, z>(base.v), load<x, z>(fp.v), sum));
+  if constexpr (z + 4 < x) mult_add<x, z + 4>(base, fp, c, add);
+}
+
+// fp.v[i] = u64::mod(base.v[i] * fp.v[i] + add)
+template <uint64_t x, uint64_t z = 0>
+KRINLNFN void mult_add(kr_tuple::tuple<x> const &base, kr_tuple::tuple<x> &fp,
+                       uint64_t const add) {
+  store<x, z>(fp.v, mult_add(load<x, z>(base.v), load<x, z>(fp.v),
+                             _mm256_set1_epi64x(add)));
+  if constexpr (z + 4 < x) mult_add<x, z + 4>(base, fp, add);
+}
+
+}  // namespace simd
+#endif
+
 // fast squaring
 constexpr uint64_t power(uint64_t base, uint64_t exponent) {
   uint64_t result = 1;
@@ -48,41 +222,88 @@ inline static uint64_t random(uint64_t min, uint64_t max) {
   return (std::uniform_int_distribution<uint64_t>(min, max))(g);
 }
 
-struct sliding_window61 {
+template <table_layout layout>
+struct basic_sliding_window61 {
  private:
+  using table_type =
+      std::conditional_t<layout == table_layout::full, uint64_t[256][256],
+                         uint64_t[256]>;
+
   uint64_t const window_size_;
   uint64_t const base_;
 
-  uint64_t const table_[256][256] = {};
+  table_type const table_ = {};
 
   double const collision_rate_ = ((double)window_size_ - 1) / (p61 - 2);
 
- public:
-  using fingerprint_type = uint64_t;
-
-  sliding_window61(uint64_t const window_size, uint64_t const base)
-      : window_size_(window_size), base_(u64::mod(base)) {
+  // The first column -c * b^tau is built with one subtraction per row, the
+  // rows d - c * b^tau with independent (vectorizable) conditional
+  // subtractions, no multiplication per entry.
+  void fill_table() {
     auto d = const_auto_cast(table_);
-    uint64_t const max_exponent = u64::power(base_, window_size_);
+    uint64_t max_exponent = u64::power(base_, window_size_);
+    max_exponent = (max_exponent >= p61) ? (max_exponent - p61) : max_exponent;
+    uint64_t first = 0;
     for (uint64_t i = 0; i < 256; ++i) {
-      d[i][0] = u64::mod(p61 - u64::mod(i * (uint128_t)max_exponent));
-      for (uint64_t j = 1; j < 256; ++j) {
-        d[i][j] = u64::mod(d[i][j - 1] + 1);
+      if constexpr (layout == table_layout::full) {
+        for (uint64_t j = 0; j < 256; ++j) {
+          uint64_t const v = first + j;
+          d[i][j] = (v >= p61) ? (v - p61) : v;
+        }
+      } else {
+        d[i] = first;
       }
+      first = (first >= max_exponent) ? (first - max_exponent)
+                                       : (first + p61 - max_exponent);
     }
+  }
+
+  table_io::header table_header() const {
+    return {table_io::magic, fingerprint_bits, (uint64_t)layout, window_size_,
+            sizeof(table_)};
+  }
+
+  // -b^tau, checked against loaded tables
+  uint64_t minus_power() const {
+    uint64_t const e = u64::canonical(u64::power(base_, window_size_));
+    return (e == 0) ? 0 : (p61 - e);
+  }
+
+ public:
+  using fingerprint_type = uint64_t;
+  constexpr static uint64_t fingerprint_bits = 61;
+
+  basic_sliding_window61(uint64_t const window_size, uint64_t const base)
+      : window_size_(window_size), base_(u64::mod(base)) {
+    fill_table();
   };
 
-  sliding_window61(uint64_t const window_size)
-      : sliding_window61(window_size, u64::random(1, p61 - 1)){};
+  // loads the table written by save_table for the same window size and base
+  basic_sliding_window61(uint64_t const window_size, uint64_t const base,
+                         std::istream &table)
+      : window_size_(window_size), base_(u64::mod(base)) {
+    table_io::load(table, table_header(), base_, table_, minus_power());
+  };
+
+  basic_sliding_window61(uint64_t const window_size)
+      : basic_sliding_window61(window_size, u64::random(1, p61 - 1)){};
 
   template <ByteType T>
   KRINLNFN uint64_t roll_right(uint64_t const fp, T const pop_left,
                                T const push_right) const {
-    auto lookup = table_[pop_left][push_right];
-    if (base_ >= p61 || fp >= p61 || lookup >= p61)
-      __builtin_unreachable();
-    else
-      return u64::mod(((uint128_t)base_) * fp + lookup);
+    if constexpr (layout == table_layout::full) {
+      auto lookup = table_[pop_left][push_right];
+      if (base_ >= p61 || fp >= p61 || lookup >= p61)
+        __builtin_unreachable();
+      else
+        return u64::mod(((uint128_t)base_) * fp + lookup);
+    } else {
+      auto lookup = table_[pop_left];
+      if (base_ >= p61 || fp >= p61 || lookup >= p61)
+        __builtin_unreachable();
+      else
+        return u64::mod(((uint128_t)base_) * fp + lookup + push_right);
+    }
   }
 
   template <ByteType T>
@@ -93,42 +314,120 @@ struct sliding_window61 {
       return u64::mod(((uint128_t)base_) * fp + push_right);
   }
 
+  // Lazy reduction: the fingerprints are kept anywhere in [0, 2^64) and only
+  // partially folded per roll (u64::fold64). The results are congruent to
+  // the ones of roll_right; canonicalize them before comparing, hashing or
+  // emitting them. Both modes can be mixed, eager fingerprints are valid lazy
+  // ones.
+  template <ByteType T>
+  KRINLNFN uint64_t roll_right_lazy(uint64_t const fp, T const pop_left,
+                                    T const push_right) const {
+    if (base_ >= p61) __builtin_unreachable();
+    if constexpr (layout == table_layout::full) {
+      return u64::fold64(((uint128_t)base_) * fp +
+                         table_[pop_left][push_right]);
+    } else {
+      return u64::fold64(((uint128_t)base_) * fp + table_[pop_left] +
+                         push_right);
+    }
+  }
+
+  template <ByteType T>
+  KRINLNFN uint64_t roll_right_lazy(uint64_t const fp,
+                                    T const push_right) const {
+    if (base_ >= p61) __builtin_unreachable();
+    return u64::fold64(((uint128_t)base_) * fp + push_right);
+  }
+
+  // the representative in [0, p) of fp, see kr-hash.hpp
+  KRINLNFN static uint64_t canonicalize(uint64_t const fp) {
+    return u64::canonical(fp);
+  }
+
+  void save_table(std::ostream &out) const {
+    table_io::save(out, table_header(), base_, table_);
+  }
+
   inline uint64_t base() const { return base_; }
   inline uint64_t window_size() const { return window_size_; }
   inline uint64_t bits() const { return 61; }
   inline double collision_rate() const { return collision_rate_; }
 };
 
-template <uint64_t x>
+using sliding_window61 = basic_sliding_window61<table_layout::full>;
+
+template <uint64_t x, table_layout layout = table_layout::full>
 struct sliding_window_multi61 {
  private:
   using tuple = kr_tuple::tuple<x>;
+  using table_type = std::conditional_t<layout == table_layout::full,
+                                        tuple[256][256], tuple[256]>;
 
   uint64_t const window_size_;
   tuple const base_;
 
-  tuple const table_[256][256] = {};
+  table_type const table_ = {};
 
   double const collision_rate_ = std::pow(((double)window_size_ - 1) / p61, x);
 
- public:
-  using fingerprint_type = tuple;
-
-  sliding_window_multi61(uint64_t const window_size, tuple base)
-      : window_size_(window_size), base_(base.apply(u64::mod)) {
+  void fill_table() {
     static_assert(x > 0);
     auto d = const_auto_cast(table_);
     tuple max_exp;
-    for (uint64_t z = 0; z < x; ++z)
-      max_exp.v[z] = u64::power(base_.v[z], window_size_);
+    for (uint64_t z = 0; z < x; ++z) {
+      uint64_t const e = u64::power(base_.v[z], window_size_);
+      max_exp.v[z] = (e >= p61) ? (e - p61) : e;
+    }
+    // as in basic_sliding_window61, lane-wise
+    tuple first;
     for (uint64_t i = 0; i < 256; ++i) {
-      for (uint64_t z = 0; z < x; ++z)
-        d[i][0].v[z] = u64::mod(p61 - u64::mod(i * (uint128_t)(max_exp.v[z])));
-      for (uint64_t j = 1; j < 256; ++j) {
-        for (uint64_t z = 0; z < x; ++z)
-          d[i][j].v[z] = u64::mod(d[i][j - 1].v[z] + 1);
+      if constexpr (layout == table_layout::full) {
+        for (uint64_t j = 0; j < 256; ++j) {
+          for (uint64_t z = 0; z < x; ++z) {
+            uint64_t const v = first.v[z] + j;
+            d[i][j].v[z] = (v >= p61) ? (v - p61) : v;
+          }
+        }
+      } else {
+        d[i] = first;
       }
+      for (uint64_t z = 0; z < x; ++z) {
+        first.v[z] = (first.v[z] >= max_exp.v[z])
+                         ? (first.v[z] - max_exp.v[z])
+                         : (first.v[z] + p61 - max_exp.v[z]);
+      }
+    }
+  }
+
+  table_io::header table_header() const {
+    return {table_io::magic, fingerprint_bits, (uint64_t)layout, window_size_,
+            sizeof(table_)};
+  }
+
+  // -b^tau lane-wise, checked against loaded tables
+  tuple minus_power() const {
+    tuple m;
+    for (uint64_t z = 0; z < x; ++z) {
+      uint64_t const e = u64::canonical(u64::power(base_.v[z], window_size_));
+      m.v[z] = (e == 0) ? 0 : (p61 - e);
     }
+    return m;
+  }
+
+ public:
+  using fingerprint_type = tuple;
+  constexpr static uint64_t fingerprint_bits = x * 61;
+
+  sliding_window_multi61(uint64_t const window_size, tuple base)
+      : window_size_(window_size), base_(base.apply(u64::mod)) {
+    fill_table();
+  };
+
+  // loads the table written by save_table for the same window size and base
+  sliding_window_multi61(uint64_t const window_size, tuple base,
+                         std::istream &table)
+      : window_size_(window_size), base_(base.apply(u64::mod)) {
+    table_io::load(table, table_header(), base_, table_, minus_power());
   };
 
   sliding_window_multi61(uint64_t const window_size)
@@ -139,18 +438,47 @@ struct sliding_window_multi61 {
   template <ByteType T>
   KRINLNFN tuple roll_right(tuple fp, T const pop_left,
                             T const push_right) const {
-    auto const &lookup = table_[pop_left][push_right];
-    for (uint64_t z = 0; z < x; ++z) {
-      if (base_.v[z] >= p61 || fp.v[z] >= p61 || lookup.v[z] >= p61)
-        __builtin_unreachable();
-      else
-        fp.v[z] = u64::mod(((uint128_t)base_.v[z]) * fp.v[z] + lookup.v[z]);
+    if constexpr (layout == table_layout::full) {
+      auto const &lookup = table_[pop_left][push_right];
+#ifdef KR_FINGERPRINTING_AVX2
+      if constexpr (x > 1) {
+        simd::mult_add(base_, fp, lookup, 0);
+        return fp;
+      }
+#endif
+      for (uint64_t z = 0; z < x; ++z) {
+        if (base_.v[z] >= p61 || fp.v[z] >= p61 || lookup.v[z] >= p61)
+          __builtin_unreachable();
+        else
+          fp.v[z] = u64::mod(((uint128_t)base_.v[z]) * fp.v[z] + lookup.v[z]);
+      }
+    } else {
+      auto const &lookup = table_[pop_left];
+#ifdef KR_FINGERPRINTING_AVX2
+      if constexpr (x > 1) {
+        simd::mult_add(base_, fp, lookup, push_right);
+        return fp;
+      }
+#endif
+      for (uint64_t z = 0; z < x; ++z) {
+        if (base_.v[z] >= p61 || fp.v[z] >= p61 || lookup.v[z] >= p61)
+          __builtin_unreachable();
+        else
+          fp.v[z] = u64::mod(((uint128_t)base_.v[z]) * fp.v[z] + lookup.v[z] +
+                             push_right);
+      }
     }
     return fp;
   }
 
   template <ByteType T>
   KRINLNFN tuple roll_right(tuple fp, T const push_right) const {
+#ifdef KR_FINGERPRINTING_AVX2
+    if constexpr (x > 1) {
+      simd::mult_add(base_, fp, push_right);
+      return fp;
+    }
+#endif
     for (uint64_t z = 0; z < x; ++z) {
       if (base_.v[z] >= p61 || fp.v[z] >= p61)
         __builtin_unreachable();
@@ -160,6 +488,41 @@ struct sliding_window_multi61 {
     return fp;
   }
 
+  // lazy reduction per lane, see basic_sliding_window61
+  template <ByteType T>
+  KRINLNFN tuple roll_right_lazy(tuple fp, T const pop_left,
+                                 T const push_right) const {
+    for (uint64_t z = 0; z < x; ++z) {
+      if (base_.v[z] >= p61) __builtin_unreachable();
+      if constexpr (layout == table_layout::full) {
+        fp.v[z] = u64::fold64(((uint128_t)base_.v[z]) * fp.v[z] +
+                              table_[pop_left][push_right].v[z]);
+      } else {
+        fp.v[z] = u64::fold64(((uint128_t)base_.v[z]) * fp.v[z] +
+                              table_[pop_left].v[z] + push_right);
+      }
+    }
+    return fp;
+  }
+
+  template <ByteType T>
+  KRINLNFN tuple roll_right_lazy(tuple fp, T const push_right) const {
+    for (uint64_t z = 0; z < x; ++z) {
+      if (base_.v[z] >= p61) __builtin_unreachable();
+      fp.v[z] = u64::fold64(((uint128_t)base_.v[z]) * fp.v[z] + push_right);
+    }
+    return fp;
+  }
+
+  // the representative in [0, p) of fp, see kr-hash.hpp
+  KRINLNFN static tuple canonicalize(tuple fp) {
+    return fp.apply(u64::canonical);
+  }
+
+  void save_table(std::ostream &out) const {
+    table_io::save(out, table_header(), base_, table_);
+  }
+
   inline tuple base() const { return base_; }
   inline uint64_t window_size() const { return window_size_; }
   inline uint64_t bits() const { return x * 61; }
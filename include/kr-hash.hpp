@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+// Hash functors for fingerprints. Reduced Karp-Rabin residues are already
+// uniformly distributed, so no mixing is needed: the hash is the low 64 bits
+// of the fingerprint (of its first lane for tuples, whose lanes are
+// independent).
+//
+// Keys have to be canonical. roll_right reduces into [0, p] rather than
+// [0, p): for p61 and the tuple lanes, a window rolled in after other bytes
+// may hold the residue 0 as p, while the same bytes pushed into an empty
+// window hold 0. Such congruent fingerprints hash and compare differently,
+// so every consumer that hashes, compares, sorts or reports fingerprints
+// passes them through window_type::canonicalize first.
+template <typename fingerprint_type>
+struct fingerprint_hash;
+
+template <>
+struct fingerprint_hash<uint64_t> {
+  KRINLNFN uint64_t operator()(uint64_t const fp) const { return fp; }
+};
+
+template <uint64_t x>
+struct fingerprint_hash<kr_tuple::tuple<x>> {
+  KRINLNFN uint64_t operator()(kr_tuple::tuple<x> const &fp) const {
+    return fp.v[0];
+  }
+};
+
+template <>
+struct fingerprint_hash<uint128_t> {
+  KRINLNFN uint64_t operator()(uint128_t const fp) const {
+    return (uint64_t)fp;
+  }
+};
+
+namespace flat {
+
+template <typename key_type, typename mapped_type>
+struct slot {
+  key_type key;
+  mapped_type value;
+};
+
+template <typename key_type>
+struct slot<key_type, void> {
+  key_type key;
+};
+
+// Open-addressing hash table in the style of Swiss tables. Slots are grouped
+// by 16; every slot has a control byte that is either empty, deleted, or the
+// lowest 7 bits of the key's hash. A probe compares the control bytes of a
+// whole group against the tag at once (SSE2), and only compares keys for
+// matching tags. The group index is taken from the remaining hash bits,
+// groups are probed linearly. The maximum load factor is 7/8.
+template <typename key_type, typename mapped_type, typename hash_type>
+class table {
+ public:
+  using slot_type = slot<key_type, mapped_type>;
+  constexpr static uint64_t group_size = 16;
+
+ private:
+  constexpr static uint8_t empty_ctrl = 0x80;
+  constexpr static uint8_t deleted_ctrl = 0xFE;
+
+  std::vector<uint8_t> ctrl_;
+  std::vector<slot_type> slots_;
+  uint64_t size_ = 0;
+  // occupied or deleted slots
+  uint64_t used_ = 0;
+  [[no_unique_address]] hash_type hash_;
+
+  KRINLNFN uint64_t groups() const { return ctrl_.size() / group_size; }
+
+  KRINLNFN static uint8_t tag(uint64_t const h) { return h & 0x7F; }
+
+  KRINLNFN uint64_t first_group(uint64_t const h) const {
+    return (h >> 7) & (groups() - 1);
+  }
+
+  // bit i is set if ctrl[i] == c
+  KRINLNFN static uint32_t match(uint8_t const *const ctrl, uint8_t const c) {
+#if defined(__SSE2__)
+    __m128i const group = _mm_loadu_si128((__m128i const *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+    uint32_t m = 0;
+    for (uint64_t i = 0; i < group_size; ++i) m |= uint32_t(ctrl[i] == c) << i;
+    return m;
+#endif
+  }
+
+  // index of the slot holding key, or capacity() if there is none
+  KRINLNFN uint64_t locate(key_type const &key, uint64_t const h) const {
+    if (size_ == 0) return capacity();
+    uint64_t const mask = groups() - 1;
+    for (uint64_t g = first_group(h);; g = (g + 1) & mask) {
+      uint8_t const *const ctrl = ctrl_.data() + g * group_size;
+      for (uint32_t m = match(ctrl, tag(h)); m != 0; m &= m - 1) {
+        uint64_t const i = g * group_size + std::countr_zero(m);
+        if (slots_[i].key == key) [[likely]]
+          return i;
+      }
+      if (match(ctrl, empty_ctrl) != 0) return capacity();
+    }
+  }
+
+  // first empty or deleted slot on the probe sequence of h
+  KRINLNFN uint64_t free_slot(uint64_t const h) const {
+    uint64_t const mask = groups() - 1;
+    for (uint64_t g = first_group(h);; g = (g + 1) & mask) {
+      uint8_t const *const ctrl = ctrl_.data() + g * group_size;
+      uint32_t const m = match(ctrl, empty_ctrl) | match(ctrl, deleted_ctrl);
+      if (m != 0) return g * group_size + std::countr_zero(m);
+    }
+  }
+
+  void rehash(uint64_t const new_capacity) {
+    std::vector<uint8_t> const old_ctrl =
+        std::exchange(ctrl_, std::vector<uint8_t>(new_capacity, empty_ctrl));
+    std::vector<slot_type> old_slots =
+        std::exchange(slots_, std::vector<slot_type>(new_capacity));
+    used_ = size_;
+    for (uint64_t i = 0; i < old_ctrl.size(); ++i) {
+      if (old_ctrl[i] & 0x80) continue;
+      uint64_t const h = hash_(old_slots[i].key);
+      uint64_t const j = free_slot(h);
+      ctrl_[j] = tag(h);
+      slots_[j] = std::move(old_slots[i]);
+    }
+  }
+
+  KRINLNFN static uint64_t capacity_for(uint64_t const n) {
+    return std::bit_ceil(std::max<uint64_t>(n + n / 7 + 1, group_size));
+  }
+
+  // slot for key, inserting it (with default value) if it does not exist
+  std::pair<slot_type *, bool> find_or_insert(key_type const &key) {
+    uint64_t const h = hash_(key);
+    uint64_t i = locate(key, h);
+    if (i != capacity()) return {&slots_[i], false};
+    if (used_ + 1 > capacity() / 8 * 7) {
+      rehash((size_ + 1 > capacity() / 2) ? 2 * capacity() : capacity());
+    }
+    i = free_slot(h);
+    used_ += (ctrl_[i] == empty_ctrl);
+    ++size_;
+    ctrl_[i] = tag(h);
+    slots_[i].key = key;
+    return {&slots_[i], true};
+  }
+
+ public:
+  explicit table(uint64_t const expected_size = 0)
+      : ctrl_(capacity_for(expected_size), empty_ctrl),
+        slots_(ctrl_.size()) {}
+
+  // Inserts the key (for sets) unless it exists. Returns the slot of the key
+  // and whether it was inserted.
+  std::pair<slot_type *, bool> insert(key_type const &key)
+    requires std::is_void_v<mapped_type>
+  {
+    return find_or_insert(key);
+  }
+
+  // Inserts key -> value unless the key exists, in which case the old value
+  // is kept. Returns the slot of the key and whether it was inserted.
+  template <typename M = mapped_type>
+    requires(!std::is_void_v<M>)
+  std::pair<slot_type *, bool> insert(key_type const &key, M const &value) {
+    auto r = find_or_insert(key);
+    if (r.second) r.first->value = value;
+    return r;
+  }
+
+  // value of the key, inserting a default value if it does not exist
+  template <typename M = mapped_type>
+    requires(!std::is_void_v<M>)
+  M &operator[](key_type const &key) {
+    return find_or_insert(key).first->value;
+  }
+
+  KRINLNFN slot_type const *find(key_type const &key) const {
+    uint64_t const i = locate(key, hash_(key));
+    return (i == capacity()) ? nullptr : &slots_[i];
+  }
+
+  KRINLNFN slot_type *find(key_type const &key) {
+    uint64_t const i = locate(key, hash_(key));
+    return (i == capacity()) ? nullptr : &slots_[i];
+  }
+
+  KRINLNFN bool contains(key_type const &key) const {
+    return find(key) != nullptr;
+  }
+
+  bool erase(key_type const &key) {
+    uint64_t const i = locate(key, hash_(key));
+    if (i == capacity()) return false;
+    ctrl_[i] = deleted_ctrl;
+    --size_;
+    return true;
+  }
+
+  // Prefetches the control bytes and first slots of the key's first group,
+  // to be issued a few keys ahead of find.
+  KRINLNFN void prefetch(key_type const &key) const {
+    uint64_t const g = first_group(hash_(key));
+    __builtin_prefetch(ctrl_.data() + g * group_size);
+    __builtin_prefetch(slots_.data() + g * group_size);
+  }
+
+  void reserve(uint64_t const n) {
+    if (capacity_for(n) > capacity()) rehash(capacity_for(n));
+  }
+
+  void clear() {
+    std::fill(ctrl_.begin(), ctrl_.end(), empty_ctrl);
+    size_ = used_ = 0;
+  }
+
+  // calls f(slot) for every key in unspecified order
+  template <typename F>
+  void for_each(F const &f) const {
+    for (uint64_t i = 0; i < capacity(); ++i) {
+      if (!(ctrl_[i] & 0x80)) f(slots_[i]);
+    }
+  }
+
+  inline uint64_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline uint64_t capacity() const { return ctrl_.size(); }
+};
+
+}  // namespace flat
+
+// Fingerprint maps and sets; the keys are canonical fingerprints, see above.
+template <typename key_type, typename mapped_type,
+          typename hash_type = fingerprint_hash<key_type>>
+using flat_fingerprint_map = flat::table<key_type, mapped_type, hash_type>;
+
+template <typename key_type, typename hash_type = fingerprint_hash<key_type>>
+using flat_fingerprint_set = flat::table<key_type, void, hash_type>;
+
+}  // namespace kr_fingerprinting
+
+// std::hash for the tuple fingerprints. There is none for uint128_t, which
+// libstdc++ already provides in GNU mode; use fingerprint_hash instead.
+namespace std {
+
+template <uint64_t x>
+struct hash<kr_fingerprinting::kr_tuple::tuple<x>>
+    : kr_fingerprinting::fingerprint_hash<kr_fingerprinting::kr_tuple::tuple<x>> {
+};
+
+}  // namespace std
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <type_traits>
+
+#include "kr-arithmetic.hpp"
+#include "kr-parallel.hpp"
+
+namespace kr_fingerprinting {
+
+// bottom_k:      the k smallest distinct window hashes of a document
+// k_permutation: the smallest hash of every one of k random permutations
+enum class minhash_scheme { bottom_k, k_permutation };
+
+// Fixed-size sketch record, trivially copyable such that arrays of sketches
+// can be stored and mapped as they are. bottom_k keeps the low 64 bits of
+// the canonical window fingerprints (arith::word, see kr-hash.hpp), sorted;
+// k_permutation keeps 32-bit minima. Unused entries (documents with fewer
+// than k distinct windows, or no window at all) hold minhash_sketch::empty.
+template <uint64_t k, minhash_scheme scheme>
+struct minhash_sketch {
+  using value_type = std::conditional_t<scheme == minhash_scheme::bottom_k,
+                                        uint64_t, uint32_t>;
+  constexpr static value_type empty = ~((value_type)0);
+  value_type v[k];
+};
+
+// Sketches documents by rolling the windows of the window size over them.
+// Bottom-k sketches keep a max-heap of the k smallest hashes seen so far,
+// most windows are rejected by a single comparison with its top.
+// k-permutation sketches hash the 32-bit folded fingerprint x of every
+// window with k multiply-add-shift functions ((a_j * x + c_j) mod 2^64) >>
+// 32, a 2-independent family in place of true permutations, and keep the
+// minimum per function. That is k hash evaluations per window, bottom-k
+// sketches are much faster to compute (but slower to compare).
+template <typename window_type, uint64_t k,
+          minhash_scheme scheme = minhash_scheme::bottom_k>
+class minhash_sketcher {
+ public:
+  using sketch_type = minhash_sketch<k, scheme>;
+
+ private:
+  static_assert(k > 0);
+  using arith = window_arithmetic<window_type>;
+
+  using value_type = typename sketch_type::value_type;
+
+  window_type const &w_;
+  uint64_t a_[k];
+  uint64_t c_[k];
+
+  template <typename F>
+  KRINLNFN void for_each_hash(std::span<uint8_t const> const text,
+                              F const &f) const {
+    uint64_t const tau = w_.window_size();
+    uint64_t const n = text.size();
+    if (n < tau) return;
+    uint8_t const *const t = text.data();
+    typename window_type::fingerprint_type fp{};
+    for (uint64_t i = 0; i < tau; ++i) fp = w_.roll_right(fp, t[i]);
+    f(arith::word(window_type::canonicalize(fp)));
+    for (uint64_t i = tau; i < n; ++i) {
+      fp = w_.roll_right(fp, t[i - tau], t[i]);
+      f(arith::word(window_type::canonicalize(fp)));
+    }
+  }
+
+ public:
+  // The window is not copied and has to outlive the sketcher. Only sketches
+  // of the same window (base) are comparable, k-permutation sketches also
+  // need the same seed.
+  minhash_sketcher(window_type const &w, uint64_t const seed = 0) : w_(w) {
+    // splitmix64
+    uint64_t s = seed;
+    auto next = [&s]() {
+      uint64_t z = (s += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    };
+    for (uint64_t j = 0; j < k; ++j) {
+      a_[j] = next();
+      c_[j] = next();
+    }
+  }
+
+  inline sketch_type sketch(std::span<uint8_t const> const text) const {
+    sketch_type s;
+    std::fill_n(s.v, k, sketch_type::empty);
+    if constexpr (scheme == minhash_scheme::bottom_k) {
+      value_type *const heap = s.v;
+      uint64_t size = 0;
+      for_each_hash(text, [&](uint64_t const h) {
+        if (size == k && !(h < heap[0])) [[likely]]
+          return;
+        if (std::find(heap, heap + size, h) != heap + size) return;
+        if (size < k) {
+          heap[size++] = h;
+          std::push_heap(heap, heap + size);
+        } else {
+          std::pop_heap(heap, heap + k);
+          heap[k - 1] = h;
+          std::push_heap(heap, heap + k);
+        }
+      });
+      std::sort(heap, heap + size);
+    } else {
+      for_each_hash(text, [&](uint64_t const word) {
+        uint64_t const x = (uint32_t)(word ^ (word >> 32));
+        for (uint64_t j = 0; j < k; ++j) {
+          s.v[j] = std::min(s.v[j], (value_type)((a_[j] * x + c_[j]) >> 32));
+        }
+      });
+    }
+    return s;
+  }
+
+  // out[i] = sketch of documents[i], out must have room for |documents|
+  // sketches. The documents are handed out to `threads` workers in small
+  // batches, such that documents of very different sizes balance.
+  inline void sketch_documents(
+      std::span<std::span<uint8_t const> const> const documents,
+      std::span<sketch_type> const out,
+      uint64_t const threads = parallel::default_threads()) const {
+    constexpr uint64_t batch = 16;
+    uint64_t const n = documents.size();
+    std::atomic<uint64_t> next = 0;
+    parallel::run(std::clamp<uint64_t>(n / batch, 1, threads),
+                  [&](uint64_t) {
+                    for (uint64_t b; (b = next.fetch_add(batch)) < n;) {
+                      for (uint64_t i = b; i < std::min(n, b + batch); ++i) {
+                        out[i] = sketch(documents[i]);
+                      }
+                    }
+                  });
+  }
+
+  inline uint64_t window_size() const { return w_.window_size(); }
+};
+
+// Estimated Jaccard similarity of the window sets of two documents.
+// k-permutation: the fraction of permutations with equal minima.
+// bottom-k: of the k smallest hashes of the union, the fraction contained in
+// both sketches.
+template <uint64_t k, minhash_scheme scheme>
+inline double estimate_jaccard(minhash_sketch<k, scheme> const &a,
+                               minhash_sketch<k, scheme> const &b) {
+  if constexpr (scheme == minhash_scheme::k_permutation) {
+    // branch-free, vectorized by the compiler
+    uint64_t equal = 0;
+    for (uint64_t j = 0; j < k; ++j) equal += (a.v[j] == b.v[j]);
+    return ((double)equal) / k;
+  } else {
+    constexpr uint64_t empty = minhash_sketch<k, scheme>::empty;
+    uint64_t i = 0;
+    uint64_t j = 0;
+    uint64_t both = 0;
+    uint64_t taken = 0;
+    for (; taken < k; ++taken) {
+      uint64_t const x = (i < k) ? a.v[i] : empty;
+      uint64_t const y = (j < k) ? b.v[j] : empty;
+      if (x == empty && y == empty) break;
+      both += (x == y);
+      i += (x <= y);
+      j += (y <= x);
+    }
+    return taken ? ((double)both) / taken : 1.0;
+  }
+}
+
+// out[i] = estimate_jaccard(query, sketches[i]), out must have room for
+// |sketches| estimates
+template <uint64_t k, minhash_scheme scheme>
+inline void estimate_jaccard(
+    minhash_sketch<k, scheme> const &query,
+    std::span<minhash_sketch<k, scheme> const> const sketches,
+    std::span<double> const out) {
+  for (uint64_t i = 0; i < sketches.size(); ++i) {
+    out[i] = estimate_jaccard(query, sketches[i]);
+  }
+}
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <vector>
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+template <typename fingerprint_type>
+struct minimizer {
+  // start of the window text[position, position + tau)
+  uint64_t position;
+  fingerprint_type fingerprint;
+};
+
+// Minimizers (winnowing): of every run of w consecutive windows of the
+// window size tau, the window with the smallest fingerprint is selected,
+// the leftmost one on ties. Consecutive runs mostly select the same window,
+// which is reported only once. Fingerprints are ordered by operator< of
+// the fingerprint type (kr_tuple::tuple::operator< for the tuples) on the
+// canonical fingerprints (see kr-hash.hpp), which are also the reported ones.
+// The windows are rolled and sampled in one pass, with the block minima of
+// van Herk / Gil-Werman: the windows are split into blocks of w, and a run
+// ending at offset o of a block is the suffix [o + 1, w) of the previous
+// block plus the prefix [0, o] of the current one. The prefix minimum is
+// updated per window, the suffix minima are computed once per block, so a
+// window costs three comparisons (which compile to conditional moves, unlike
+// the unpredictable pops of a monotone deque). Only the fingerprints of two
+// blocks are buffered, the ones of the text are never materialized.
+template <typename window_type>
+class minimizer_sampler {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  using minimizer_type = minimizer<fingerprint_type>;
+
+ private:
+  window_type const &w_;
+  uint64_t const run_;
+
+ public:
+  // The window is not copied and has to outlive the sampler. w is raised
+  // to 1, with w = 1 every window is selected.
+  minimizer_sampler(window_type const &w, uint64_t const run)
+      : w_(w), run_(std::max<uint64_t>(run, 1)) {}
+
+  // Calls f(minimizer) for every selected window in increasing order of
+  // the positions, returns the number of selected windows. A text with
+  // fewer than w windows is a single run.
+  template <typename F>
+  uint64_t sample(std::span<uint8_t const> const text, F const &f) const {
+    uint64_t const tau = w_.window_size();
+    uint64_t const n = text.size();
+    if (n < tau) return 0;
+    uint64_t const windows = n - tau + 1;
+    uint8_t const *const t = text.data();
+    uint64_t const w = run_;
+
+    // the blocks alternate between fps[0, w) and fps[w, 2w); minima are
+    // slots of fps, suffix[o] the minimum of the previous block's [o, w)
+    std::vector<fingerprint_type> fps(2 * w);
+    std::vector<uint64_t> suffix(w);
+    uint64_t current = 0;
+    uint64_t block_start = 0;
+    uint64_t prefix = 0;
+    uint64_t selected = 0;
+    uint64_t last = windows;
+
+    auto report = [&](uint64_t const slot) {
+      // slot of the current or of the previous block
+      uint64_t const position =
+          (slot - current < w) ? block_start + (slot - current)
+                               : block_start - w + (slot - (w - current));
+      if (position != last) {
+        last = position;
+        ++selected;
+        f(minimizer_type{position, fps[slot]});
+      }
+    };
+
+    fingerprint_type fp{};
+    for (uint64_t i = 0; i < tau; ++i) fp = w_.roll_right(fp, t[i]);
+    for (uint64_t i = 0; i < windows; ++i) {
+      if (i > 0) fp = w_.roll_right(fp, t[i - 1], t[i - 1 + tau]);
+      uint64_t const o = i - block_start;
+      fps[current + o] = window_type::canonicalize(fp);
+      prefix =
+          (o == 0 || fps[current + o] < fps[prefix]) ? current + o : prefix;
+
+      if (i + 1 >= w) {
+        uint64_t m = prefix;
+        if (o + 1 < w) {
+          uint64_t const s = suffix[o + 1];
+          m = (fps[m] < fps[s]) ? m : s;
+        }
+        report(m);
+      }
+
+      if (o + 1 == w) {
+        suffix[w - 1] = current + w - 1;
+        for (uint64_t k = w - 1; k-- > 0;) {
+          uint64_t const s = suffix[k + 1];
+          suffix[k] = (fps[s] < fps[current + k]) ? s : current + k;
+        }
+        block_start += w;
+        current = w - current;
+      }
+    }
+    if (windows < w) report(prefix);
+    return selected;
+  }
+
+  inline uint64_t run() const { return run_; }
+  inline uint64_t window_size() const { return w_.window_size(); }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace kr_fingerprinting {
+
+// Read-only memory mapping of a whole file. The pages are advised for
+// sequential access and read-ahead, so the rolling loop can run directly on
+// the file contents without copying them into a buffer first. With
+// populate = true, MAP_POPULATE prefaults the whole mapping up front instead
+// of paying a page fault on first touch.
+class mapped_file {
+ private:
+  uint8_t const *data_ = nullptr;
+  uint64_t size_ = 0;
+
+  [[noreturn]] static void fail(std::string const &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+ public:
+  explicit mapped_file(std::string const &path, bool const populate = false) {
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) fail("open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      fail("fstat " + path);
+    }
+    size_ = st.st_size;
+
+    if (size_ > 0) {
+      int const flags = MAP_PRIVATE | (populate ? MAP_POPULATE : 0);
+      void *const map = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+      if (map == MAP_FAILED) {
+        ::close(fd);
+        fail("mmap " + path);
+      }
+      data_ = (uint8_t const *)map;
+      ::madvise(map, size_, MADV_SEQUENTIAL);
+      ::madvise(map, size_, MADV_WILLNEED);
+    }
+    // the mapping stays valid after closing the descriptor
+    ::close(fd);
+  }
+
+  mapped_file(mapped_file const &) = delete;
+  mapped_file &operator=(mapped_file const &) = delete;
+
+  mapped_file(mapped_file &&o) noexcept
+      : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)) {}
+
+  mapped_file &operator=(mapped_file &&o) noexcept {
+    std::swap(data_, o.data_);
+    std::swap(size_, o.size_);
+    return *this;
+  }
+
+  ~mapped_file() {
+    if (data_ != nullptr) ::munmap((void *)data_, size_);
+  }
+
+  // Hint that [offset, offset + length) is needed soon, e.g. the next blocks
+  // ahead of a scanner on inputs larger than the kernel read-ahead.
+  inline void will_need(uint64_t offset, uint64_t length) const {
+    if (offset >= size_) return;
+    uint64_t const page = ::sysconf(_SC_PAGESIZE);
+    uint64_t const begin = offset / page * page;
+    length = std::min(length, size_ - offset) + (offset - begin);
+    ::madvise((void *)(data_ + begin), length, MADV_WILLNEED);
+  }
+
+  inline uint8_t const *data() const { return data_; }
+  inline uint64_t size() const { return size_; }
+  inline std::span<uint8_t const> span() const { return {data_, size_}; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+// Rolls windows of several lengths over a text in a single pass. Every length
+// has its own base and a compact pop table (-c * b^tau); each text byte is
+// loaded once and pushed into all windows, the popped bytes are at most
+// max(tau) positions behind and still cached. The fingerprints are the same
+// as the ones of the individual windows.
+template <typename window_type>
+class multi_length_scanner {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  struct length {
+    uint64_t tau;
+    fingerprint_type base;
+    fingerprint_type pop[256];
+  };
+
+  std::vector<length> lengths_;
+  uint64_t max_tau_ = 0;
+
+  void add_length(uint64_t const tau, fingerprint_type const &base) {
+    length &l = lengths_.emplace_back();
+    l.tau = tau;
+    l.base = base;
+    fingerprint_type const max_exponent = arith::power(base, tau);
+    for (uint64_t c = 0; c < 256; ++c) {
+      l.pop[c] = arith::sub(fingerprint_type(),
+                            arith::mult(arith::scalar(c), max_exponent));
+    }
+    max_tau_ = std::max(max_tau_, tau);
+  }
+
+ public:
+  // one length per window, using the window's base and size
+  multi_length_scanner(std::span<window_type const *const> const windows) {
+    lengths_.reserve(windows.size());
+    for (auto const *w : windows) add_length(w->window_size(), w->base());
+  }
+
+  // all lengths share the same base
+  multi_length_scanner(std::span<uint64_t const> const taus,
+                       fingerprint_type const &base) {
+    lengths_.reserve(taus.size());
+    for (uint64_t const tau : taus) add_length(tau, base);
+  }
+
+  // Calls f(k, i, fp) for every window text[i, i + tau_k) of every length k,
+  // ordered by the end of the window (and by k for equal ends).
+  template <typename F>
+  void scan(std::span<uint8_t const> const text, F const &f) const {
+    uint64_t const n = text.size();
+    uint64_t const lengths = lengths_.size();
+    uint8_t const *const t = text.data();
+    std::vector<fingerprint_type> fp(lengths);
+
+    // windows that are not full yet
+    uint64_t i = 0;
+    for (; i < std::min(n, max_tau_); ++i) {
+      auto const c = arith::scalar(t[i]);
+      for (uint64_t k = 0; k < lengths; ++k) {
+        length const &l = lengths_[k];
+        if (i < l.tau) {
+          fp[k] = arith::mult_add(l.base, fp[k], c);
+          if (i + 1 == l.tau) f(k, 0, fp[k]);
+        } else {
+          auto const lookup = arith::add(l.pop[t[i - l.tau]], c);
+          fp[k] = arith::mult_add(l.base, fp[k], lookup);
+          f(k, i + 1 - l.tau, fp[k]);
+        }
+      }
+    }
+
+    for (; i < n; ++i) {
+      auto const c = arith::scalar(t[i]);
+      for (uint64_t k = 0; k < lengths; ++k) {
+        length const &l = lengths_[k];
+        auto const lookup = arith::add(l.pop[t[i - l.tau]], c);
+        fp[k] = arith::mult_add(l.base, fp[k], lookup);
+        f(k, i + 1 - l.tau, fp[k]);
+      }
+    }
+  }
+
+  inline uint64_t lengths() const { return lengths_.size(); }
+  inline uint64_t window_size(uint64_t const k) const { return lengths_[k].tau; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "kr-bulk.hpp"
+
+namespace kr_fingerprinting {
+
+namespace parallel {
+
+inline uint64_t default_threads() {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Fork-join: runs f(t) for all t in [0, threads), f(0) on the calling thread.
+template <typename F>
+inline void run(uint64_t const threads, F const &f) {
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (uint64_t t = 1; t < threads; ++t) workers.emplace_back(f, t);
+  f(0);
+  for (auto &worker : workers) worker.join();
+}
+
+// Splits [0, n) into `threads` contiguous ranges. Range boundaries are
+// multiples of `align`: with align * sizeof(element) a multiple of 64 bytes,
+// workers only share cache lines of the output array if the array itself is
+// not 64-byte aligned (then at most one line per boundary).
+struct partition {
+  uint64_t const n;
+  uint64_t const threads;
+  uint64_t const align;
+
+  inline uint64_t begin(uint64_t const t) const {
+    uint64_t const b = (n / threads) * t;
+    return std::min(n, (b + align - 1) / align * align);
+  }
+
+  inline uint64_t end(uint64_t const t) const {
+    return (t + 1 == threads) ? n : begin(t + 1);
+  }
+};
+
+// Workers with less than this many windows are not worth a thread.
+constexpr static uint64_t min_windows_per_thread = 1ULL << 16;
+
+inline uint64_t useful_threads(uint64_t const windows, uint64_t const threads) {
+  return std::clamp<uint64_t>(windows / min_windows_per_thread, 1, threads);
+}
+
+}  // namespace parallel
+
+// Same result as fingerprint_windows(w, text, out), but the windows are split
+// between `threads` workers. Each worker seeds the first window of its range
+// with roll_right(fp, push_right) and rolls the rest. The results are
+// canonical (see kr-hash.hpp), so they do not depend on the number of threads.
+template <typename window_type>
+inline void parallel_fingerprint_windows(
+    window_type const &w, std::span<uint8_t const> const text,
+    std::span<typename window_type::fingerprint_type> const out,
+    uint64_t const threads = parallel::default_threads()) {
+  uint64_t const tau = w.window_size();
+  if (text.size() < tau) return;
+  uint64_t const windows = text.size() - tau + 1;
+
+  parallel::partition const part{windows,
+                                 parallel::useful_threads(windows, threads), 64};
+  parallel::run(part.threads, [&](uint64_t const t) {
+    uint64_t const b = part.begin(t);
+    uint64_t const e = part.end(t);
+    if (b == e) return;
+    fingerprint_windows(w, text.subspan(b, e - b + tau - 1),
+                        out.subspan(b, e - b));
+  });
+}
+
+// Calls f(i, fp) for every window text[i, i + tau). The calls are made
+// concurrently by `threads` workers; each worker handles a contiguous range
+// of windows in increasing order, so f must be safe to call concurrently for
+// different i. The fingerprints are canonical (see kr-hash.hpp), so they do
+// not depend on the number of threads.
+template <typename window_type, typename F>
+inline void parallel_for_each_window(
+    window_type const &w, std::span<uint8_t const> const text, F const &f,
+    uint64_t const threads = parallel::default_threads()) {
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+  uint64_t const tau = w.window_size();
+  if (text.size() < tau) return;
+  uint64_t const windows = text.size() - tau + 1;
+
+  parallel::partition const part{windows,
+                                 parallel::useful_threads(windows, threads), 1};
+  parallel::run(part.threads, [&](uint64_t const t) {
+    uint64_t const b = part.begin(t);
+    uint64_t const e = part.end(t);
+    if (b == e) return;
+    uint8_t const *const s = text.data();
+    fingerprint_type fp = fingerprint_type();
+    for (uint64_t i = b; i < b + tau; ++i) {
+      fp = w.roll_right(fp, s[i]);
+    }
+    f(b, window_type::canonicalize(fp));
+    for (uint64_t i = b + 1; i < e; ++i) {
+      fp = w.roll_right(fp, s[i - 1], s[i - 1 + tau]);
+      f(i, window_type::canonicalize(fp));
+    }
+  });
+}
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "kr-hash.hpp"
+
+namespace kr_fingerprinting {
+
+// Finds all occurrences of a set of patterns of length tau in a single
+// rolling pass. The pattern fingerprints are stored in a flat_fingerprint_map;
+// the rolling runs `lookahead` windows ahead of the probes and prefetches
+// their groups, so the table probes do not stall the roll. Without
+// verification, a reported match is correct with high probability; with
+// verification, the patterns are copied and every match is compared byte by
+// byte. The table keys are canonical, see kr-hash.hpp.
+template <typename window_type>
+class pattern_matcher {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t lookahead = 8;
+
+ private:
+  window_type const &w_;
+  uint64_t const tau_;
+  flat_fingerprint_map<fingerprint_type, uint64_t> table_;
+  std::vector<uint8_t> patterns_;
+  bool const verify_;
+
+ public:
+  // `patterns` is the concatenation of the patterns, each of length tau.
+  // Pattern ids are their indices; of several equal patterns, the first id
+  // is reported. The window is not copied and has to outlive the matcher.
+  pattern_matcher(window_type const &w, std::span<uint8_t const> const patterns,
+                  bool const verify = false)
+      : w_(w),
+        tau_(w.window_size()),
+        table_(patterns.size() / std::max<uint64_t>(tau_, 1)),
+        verify_(verify) {
+    if (tau_ == 0 || patterns.size() % tau_ != 0)
+      throw std::invalid_argument(
+          "pattern_matcher: pattern lengths must equal the window size");
+    if (verify_) patterns_.assign(patterns.begin(), patterns.end());
+
+    uint64_t const count = patterns.size() / tau_;
+    uint8_t const *const p = patterns.data();
+    for (uint64_t id = 0; id < count; ++id) {
+      fingerprint_type fp = fingerprint_type();
+      for (uint64_t i = 0; i < tau_; ++i) {
+        fp = w_.roll_right(fp, p[id * tau_ + i]);
+      }
+      table_.insert(window_type::canonicalize(fp), id);
+    }
+  }
+
+  // Calls f(i, id) for every window text[i, i + tau) that matches pattern
+  // id, in increasing order of i. Returns the number of matches.
+  template <typename F>
+  uint64_t search(std::span<uint8_t const> const text, F const &f) const {
+    if (text.size() < tau_) return 0;
+    uint64_t const windows = text.size() - tau_ + 1;
+    uint8_t const *const t = text.data();
+    constexpr uint64_t mask = lookahead - 1;
+    static_assert(std::has_single_bit(lookahead));
+
+    // ring[i & mask] holds the fingerprint of window i
+    fingerprint_type ring[lookahead] = {};
+    fingerprint_type fp = fingerprint_type();
+    for (uint64_t i = 0; i < tau_; ++i) {
+      fp = w_.roll_right(fp, t[i]);
+    }
+    ring[0] = window_type::canonicalize(fp);
+    table_.prefetch(ring[0]);
+    uint64_t ahead = 1;
+    for (; ahead < std::min(lookahead, windows); ++ahead) {
+      fp = w_.roll_right(fp, t[ahead - 1], t[ahead - 1 + tau_]);
+      ring[ahead] = window_type::canonicalize(fp);
+      table_.prefetch(ring[ahead]);
+    }
+
+    uint64_t matches = 0;
+    for (uint64_t i = 0; i < windows; ++i) {
+      // window i + lookahead replaces window i in the ring
+      fingerprint_type const current = ring[i & mask];
+      if (ahead < windows) {
+        fp = w_.roll_right(fp, t[ahead - 1], t[ahead - 1 + tau_]);
+        ring[ahead & mask] = window_type::canonicalize(fp);
+        table_.prefetch(ring[ahead & mask]);
+        ++ahead;
+      }
+      auto const *const slot = table_.find(current);
+      if (slot != nullptr) [[unlikely]] {
+        uint64_t const id = slot->value;
+        if (verify_ &&
+            std::memcmp(t + i, patterns_.data() + id * tau_, tau_) != 0)
+          continue;
+        f(i, id);
+        ++matches;
+      }
+    }
+    return matches;
+  }
+
+  inline uint64_t patterns() const { return table_.size(); }
+  inline uint64_t window_size() const { return tau_; }
+};
+
+}  // namespace kr_fingerprinting
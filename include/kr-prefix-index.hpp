@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+#include "kr-parallel.hpp"
+
+namespace kr_fingerprinting {
+
+// Calls f(i, fp(T[0, i + 1))) for every i < |T|, i.e. for every value of the
+// sequential loop fp = w.roll_right(fp, T[i]). Two-pass blocked scan with
+// `threads` workers:
+//  1. every worker computes the fingerprint of its block and b^|block|
+//  2. the block fingerprints are combined sequentially with
+//     fp(AB) = fp(A) * b^|B| + fp(B), giving the prefix before each block
+//  3. every worker continues rolling from the prefix before its block
+// Each worker calls f for its block in increasing order of i.
+template <typename window_type, typename F>
+inline void parallel_prefix_fingerprints(
+    window_type const &w, std::span<uint8_t const> const text, F const &f,
+    uint64_t const threads = parallel::default_threads()) {
+  using fingerprint_type = typename window_type::fingerprint_type;
+  using arith = window_arithmetic<window_type>;
+
+  uint64_t const n = text.size();
+  parallel::partition const part{n, parallel::useful_threads(n, threads), 64};
+  uint8_t const *const t = text.data();
+
+  std::vector<fingerprint_type> block_fp(part.threads);
+  std::vector<fingerprint_type> block_power(part.threads);
+  if (part.threads > 1) {
+    parallel::run(part.threads, [&](uint64_t const k) {
+      fingerprint_type fp = fingerprint_type();
+      for (uint64_t i = part.begin(k); i < part.end(k); ++i) {
+        fp = w.roll_right(fp, t[i]);
+      }
+      block_fp[k] = fp;
+      block_power[k] = arith::power(w.base(), part.end(k) - part.begin(k));
+    });
+  }
+
+  std::vector<fingerprint_type> block_start(part.threads);
+  block_start[0] = fingerprint_type();
+  for (uint64_t k = 1; k < part.threads; ++k) {
+    block_start[k] = arith::mult_add(block_start[k - 1], block_power[k - 1],
+                                     block_fp[k - 1]);
+  }
+
+  parallel::run(part.threads, [&](uint64_t const k) {
+    fingerprint_type fp = block_start[k];
+    for (uint64_t i = part.begin(k); i < part.end(k); ++i) {
+      fp = w.roll_right(fp, t[i]);
+      f(i, fp);
+    }
+  });
+}
+
+// out[i] = fp(T[0, i + 1)) for all i < |T|
+template <typename window_type>
+inline void parallel_prefix_fingerprints(
+    window_type const &w, std::span<uint8_t const> const text,
+    std::span<typename window_type::fingerprint_type> const out,
+    uint64_t const threads = parallel::default_threads()) {
+  parallel_prefix_fingerprints(
+      w, text,
+      [&](uint64_t const i, typename window_type::fingerprint_type const &fp) {
+        out[i] = fp;
+      },
+      threads);
+}
+
+// Fingerprints of arbitrary substrings T[i, j) in O(sample) time, using the
+// base of a sliding window. substring_fp(i, i + tau) equals the fingerprint
+// that the window computes for T[i, i + tau).
+//
+// Only every sample-th prefix fingerprint is stored, and the powers of the
+// base are split into b^(q * sample) and b^r for r <= sample. This needs
+// 2n / sample + sample fingerprints of memory. With sample = 1, queries take
+// O(1) time. The text is not copied and has to outlive the index. The prefix
+// fingerprints are computed with `threads` workers.
+template <typename window_type>
+class prefix_index {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  std::span<uint8_t const> const text_;
+  fingerprint_type const base_;
+  uint64_t const sample_;
+
+  // prefix_[q] = fp(T[0, q * sample))
+  std::vector<fingerprint_type> prefix_;
+  // large_powers_[q] = b^(q * sample), small_powers_[r] = b^r
+  std::vector<fingerprint_type> large_powers_;
+  std::vector<fingerprint_type> small_powers_;
+
+  KRINLNFN bool equal(uint64_t const i, uint64_t const j,
+                      uint64_t const len) const {
+    return substring_fp(i, i + len) == substring_fp(j, j + len);
+  }
+
+ public:
+  prefix_index(window_type const &w, std::span<uint8_t const> const text,
+               uint64_t const sample = 1, uint64_t const threads = 1)
+      : text_(text), base_(w.base()), sample_(std::max<uint64_t>(sample, 1)) {
+    uint64_t const n = text_.size();
+    uint64_t const samples = n / sample_ + 1;
+
+    prefix_.resize(samples);
+    prefix_[0] = fingerprint_type();
+    parallel_prefix_fingerprints(
+        w, text_,
+        [&](uint64_t const i, fingerprint_type const &fp) {
+          if ((i + 1) % sample_ == 0) prefix_[(i + 1) / sample_] = fp;
+        },
+        threads);
+
+    small_powers_.resize(sample_ + 1);
+    small_powers_[0] = arith::scalar(1);
+    for (uint64_t r = 1; r <= sample_; ++r)
+      small_powers_[r] = arith::mult(small_powers_[r - 1], base_);
+
+    large_powers_.resize(samples);
+    large_powers_[0] = arith::scalar(1);
+    for (uint64_t q = 1; q < samples; ++q)
+      large_powers_[q] = arith::mult(large_powers_[q - 1], small_powers_[sample_]);
+  }
+
+  // b^e for e <= |T|
+  KRINLNFN fingerprint_type power(uint64_t const e) const {
+    if (sample_ == 1) return large_powers_[e];
+    return arith::mult(large_powers_[e / sample_], small_powers_[e % sample_]);
+  }
+
+  // fp(T[0, i))
+  KRINLNFN fingerprint_type prefix_fp(uint64_t const i) const {
+    uint64_t const q = i / sample_;
+    fingerprint_type fp = prefix_[q];
+    for (uint64_t k = q * sample_; k < i; ++k)
+      fp = arith::mult_add(base_, fp, arith::scalar(text_[k]));
+    return fp;
+  }
+
+  // fp(T[i, j)) = fp(T[0, j)) - fp(T[0, i)) * b^(j - i)
+  KRINLNFN fingerprint_type substring_fp(uint64_t const i,
+                                         uint64_t const j) const {
+    return arith::sub(prefix_fp(j), arith::mult(prefix_fp(i), power(j - i)));
+  }
+
+  // Length of the longest common prefix of T[i, n) and T[j, n) (correct with
+  // high probability). Exponential search followed by binary search, i.e.
+  // O(log lce) substring fingerprints.
+  uint64_t lce(uint64_t const i, uint64_t const j) const {
+    uint64_t const n = text_.size();
+    if (i == j) return n - i;
+    uint64_t const max = n - std::max(i, j);
+
+    // equal(i, j, lo) holds, equal(i, j, hi) does not (or hi > max)
+    uint64_t lo = 0;
+    uint64_t step = 1;
+    while (lo + step <= max && equal(i, j, lo + step)) {
+      lo += step;
+      step *= 2;
+    }
+    uint64_t hi = std::min(lo + step, max + 1);
+    while (hi - lo > 1) {
+      uint64_t const mid = lo + (hi - lo) / 2;
+      if (equal(i, j, mid))
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  inline fingerprint_type base() const { return base_; }
+  inline uint64_t size() const { return text_.size(); }
+  inline uint64_t sample_rate() const { return sample_; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+#include "kr-parallel.hpp"
+
+namespace kr_fingerprinting {
+
+namespace repeats {
+
+// Sort key of a window: the uniformly distributed bits of its fingerprint
+// (arith::word) and its position. Keys are 16 bytes for all fingerprint
+// types, the full fingerprints are only compared for equal words.
+struct key {
+  uint64_t word;
+  uint64_t position;
+
+  KRINLNFN bool operator<(key const &o) const {
+    return (word != o.word) ? (word < o.word) : (position < o.position);
+  }
+};
+
+// Number of uniformly distributed bits of arith::word: the p61 residues
+// (and lanes) are below 2^61, the low 64 bits of the 128-bit residues are
+// uniform.
+template <typename fingerprint_type>
+constexpr static uint64_t word_bits = 61;
+
+template <>
+constexpr uint64_t word_bits<uint128_t> = 64;
+
+// Sorts the keys with one MSD radix pass on the top `bits` of the words,
+// then std::sort of the buckets. The words are uniform, so the buckets are
+// of about the same size and small enough to be sorted in cache. Both steps
+// are split between `threads` workers.
+inline void sort(std::vector<key> &keys, uint64_t const bits,
+                 uint64_t const threads) {
+  uint64_t const n = keys.size();
+  // about 256 keys per bucket
+  uint64_t const radix = std::clamp<uint64_t>(std::bit_width(n >> 8), 1, 16);
+  uint64_t const buckets = 1ULL << radix;
+  uint64_t const shift = bits - radix;
+
+  parallel::partition const part{n, parallel::useful_threads(n, threads), 1};
+  std::vector<uint64_t> counts(part.threads * buckets);
+  parallel::run(part.threads, [&](uint64_t const t) {
+    uint64_t *const c = counts.data() + t * buckets;
+    for (uint64_t i = part.begin(t); i < part.end(t); ++i) {
+      ++c[keys[i].word >> shift];
+    }
+  });
+
+  // counts[t * buckets + b] becomes the output offset of worker t in b
+  std::vector<uint64_t> bounds(buckets + 1);
+  uint64_t sum = 0;
+  for (uint64_t b = 0; b < buckets; ++b) {
+    bounds[b] = sum;
+    for (uint64_t t = 0; t < part.threads; ++t) {
+      uint64_t const c = counts[t * buckets + b];
+      counts[t * buckets + b] = sum;
+      sum += c;
+    }
+  }
+  bounds[buckets] = n;
+
+  std::vector<key> sorted(n);
+  parallel::run(part.threads, [&](uint64_t const t) {
+    uint64_t *const offset = counts.data() + t * buckets;
+    for (uint64_t i = part.begin(t); i < part.end(t); ++i) {
+      sorted[offset[keys[i].word >> shift]++] = keys[i];
+    }
+  });
+  keys.swap(sorted);
+
+  std::atomic<uint64_t> next = 0;
+  parallel::run(std::min(threads, buckets), [&](uint64_t) {
+    for (uint64_t b; (b = next.fetch_add(1)) < buckets;) {
+      std::sort(keys.begin() + bounds[b], keys.begin() + bounds[b + 1]);
+    }
+  });
+}
+
+}  // namespace repeats
+
+// Finds all repeated substrings of the window size: the fingerprints of all
+// windows are computed in parallel, their words are sorted together with the
+// positions (repeats::sort), and runs of equal fingerprints are reported. With
+// verification, the windows of a run are compared byte by byte and split
+// into groups of equal content, which removes fingerprint collisions.
+template <typename window_type>
+class repeat_finder {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  window_type const &w_;
+  bool const verify_;
+  uint64_t const threads_;
+
+  // Calls f(fp, positions) for every group of at least two equal windows
+  // among the given positions, which all have the fingerprint fp. Returns
+  // the number of groups.
+  template <typename F>
+  uint64_t report(uint8_t const *const t, fingerprint_type const &fp,
+                  std::span<uint64_t> const positions, F const &f) const {
+    if (!verify_) {
+      f(fp, std::span<uint64_t const>(positions));
+      return 1;
+    }
+
+    uint64_t const tau = w_.window_size();
+    uint64_t groups = 0;
+    auto rest = positions.begin();
+    while (positions.end() - rest >= 2) {
+      uint8_t const *const first = t + *rest;
+      // the group of the first remaining window, in order of the positions
+      auto const group_end =
+          std::stable_partition(rest, positions.end(), [&](uint64_t const p) {
+            return std::memcmp(t + p, first, tau) == 0;
+          });
+      if (group_end - rest >= 2) {
+        f(fp, std::span<uint64_t const>(rest, group_end));
+        ++groups;
+      }
+      rest = group_end;
+    }
+    return groups;
+  }
+
+  // Positions of windows with equal words, split into runs of equal
+  // fingerprints (almost always a single run).
+  template <typename F>
+  uint64_t split(uint8_t const *const t,
+                 std::vector<fingerprint_type> const &fps,
+                 std::vector<uint64_t> &positions, F const &f) const {
+    fingerprint_type const &first = fps[positions[0]];
+    if (std::all_of(positions.begin(), positions.end(),
+                    [&](uint64_t const p) { return fps[p] == first; })) {
+      return report(t, first, positions, f);
+    }
+    std::sort(positions.begin(), positions.end(),
+              [&](uint64_t const x, uint64_t const y) {
+                return (fps[x] == fps[y]) ? (x < y) : (fps[x] < fps[y]);
+              });
+    uint64_t groups = 0;
+    for (uint64_t i = 0, j; i < positions.size(); i = j) {
+      for (j = i + 1;
+           j < positions.size() && fps[positions[j]] == fps[positions[i]];) {
+        ++j;
+      }
+      if (j - i >= 2) {
+        groups += report(t, fps[positions[i]],
+                         std::span<uint64_t>(positions).subspan(i, j - i), f);
+      }
+    }
+    return groups;
+  }
+
+ public:
+  // The window is not copied and has to outlive the finder.
+  repeat_finder(window_type const &w, bool const verify = false,
+                uint64_t const threads = parallel::default_threads())
+      : w_(w), verify_(verify), threads_(std::max<uint64_t>(threads, 1)) {}
+
+  // Calls f(fp, positions) for every group of windows with the same
+  // fingerprint (and the same content, with verification) that occurs at
+  // least twice, positions in increasing order; fp is the canonical
+  // fingerprint. Returns the number of groups. The groups are reported by the
+  // calling thread.
+  template <typename F>
+  uint64_t find(std::span<uint8_t const> const text, F const &f) const {
+    uint64_t const tau = w_.window_size();
+    if (text.size() < tau) return 0;
+    uint64_t const windows = text.size() - tau + 1;
+
+    // the full fingerprints, unless they are the words
+    constexpr bool words_only = std::is_same_v<fingerprint_type, uint64_t>;
+    std::vector<fingerprint_type> fps(words_only ? 0 : windows);
+    std::vector<repeats::key> keys(windows);
+    parallel::partition const part{
+        windows, parallel::useful_threads(windows, threads_), 1};
+    parallel::run(part.threads, [&](uint64_t const t) {
+      uint64_t const b = part.begin(t);
+      uint64_t const e = part.end(t);
+      if (b == e) return;
+      uint8_t const *const s = text.data();
+      // the canonical fingerprints (see kr-hash.hpp) are stored and sorted
+      auto const store = [&](uint64_t const i, fingerprint_type const &fp) {
+        fingerprint_type const c = window_type::canonicalize(fp);
+        if constexpr (!words_only) fps[i] = c;
+        keys[i] = {arith::word(c), i};
+      };
+      fingerprint_type fp = fingerprint_type();
+      for (uint64_t i = b; i < b + tau; ++i) fp = w_.roll_right(fp, s[i]);
+      store(b, fp);
+      for (uint64_t i = b + 1; i < e; ++i) {
+        fp = w_.roll_right(fp, s[i - 1], s[i - 1 + tau]);
+        store(i, fp);
+      }
+    });
+
+    repeats::sort(keys, repeats::word_bits<fingerprint_type>, threads_);
+
+    std::vector<uint64_t> positions;
+    uint64_t groups = 0;
+    for (uint64_t b = 0, e; b < windows; b = e) {
+      for (e = b + 1; e < windows && keys[e].word == keys[b].word;) ++e;
+      if (e - b < 2) continue;
+
+      positions.clear();
+      for (uint64_t i = b; i < e; ++i) positions.push_back(keys[i].position);
+      if constexpr (words_only) {
+        groups += report(text.data(), keys[b].word, positions, f);
+      } else {
+        groups += split(text.data(), fps, positions, f);
+      }
+    }
+    return groups;
+  }
+
+  // Documents in increasing order of position, document d is
+  // text[begins[d], ends[d]) with ends[d] <= begins[d + 1]; bytes outside of
+  // all documents (e.g. separators) belong to none. Calls f(fp, documents)
+  // for every window content that occurs in at least two documents, with the
+  // distinct documents in increasing order. Windows that are not inside a
+  // single document are ignored. Returns the number of reported windows.
+  template <typename F>
+  uint64_t find_shared(std::span<uint8_t const> const text,
+                       std::span<uint64_t const> const begins,
+                       std::span<uint64_t const> const ends,
+                       F const &f) const {
+    uint64_t const n = std::min(begins.size(), ends.size());
+    if (n < 2) return 0;
+    uint64_t const tau = w_.window_size();
+    std::vector<uint64_t> documents;
+    uint64_t shared = 0;
+    find(text, [&](fingerprint_type const &fp,
+                   std::span<uint64_t const> const positions) {
+      documents.clear();
+      auto d = begins.begin();
+      for (uint64_t const p : positions) {
+        // positions are increasing, so is the document
+        auto const next = std::upper_bound(d, begins.begin() + n, p);
+        // before the first document
+        if (next == begins.begin()) continue;
+        d = next - 1;
+        uint64_t const document = d - begins.begin();
+        if (p + tau > ends[document]) continue;
+        if (documents.empty() || documents.back() != document) {
+          documents.push_back(document);
+        }
+      }
+      if (documents.size() >= 2) {
+        f(fp, std::span<uint64_t const>(documents));
+        ++shared;
+      }
+    });
+    return shared;
+  }
+
+  // Documents stored back to back, document d is text[offsets[d],
+  // offsets[d + 1]). Bytes before offsets[0] belong to no document.
+  template <typename F>
+  inline uint64_t find_shared(std::span<uint8_t const> const text,
+                              std::span<uint64_t const> const offsets,
+                              F const &f) const {
+    if (offsets.size() < 2) return 0;
+    return find_shared(text, offsets.first(offsets.size() - 1),
+                       offsets.subspan(1), f);
+  }
+
+  inline bool verify() const { return verify_; }
+  inline uint64_t threads() const { return threads_; }
+  inline uint64_t window_size() const { return w_.window_size(); }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <system_error>
+#include <vector>
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+namespace stream {
+
+constexpr static uint64_t default_block_size = 1ULL << 20;
+
+// Reads up to `size` bytes, returns 0 only at the end of the input.
+struct fd_reader {
+  int const fd;
+
+  inline uint64_t operator()(uint8_t *const data, uint64_t const size) const {
+    while (true) {
+      ssize_t const r = ::read(fd, data, size);
+      if (r >= 0) return r;
+      if (errno != EINTR)
+        throw std::system_error(errno, std::generic_category(), "read");
+    }
+  }
+};
+
+// Reads from a std::istream. A short read sets eofbit and failbit, which end
+// the input; badbit is a read error and throws.
+struct istream_reader {
+  std::istream &s;
+
+  inline uint64_t operator()(uint8_t *const data, uint64_t const size) const {
+    s.read((char *)data, size);
+    if (s.bad()) throw std::ios_base::failure("read", std::io_errc::stream);
+    return s.gcount();
+  }
+};
+
+// Calls f(i, fp) for every window [i, i + tau) of the input produced by
+// read(data, size), in increasing order of i. The input is processed in
+// blocks; the buffer holds the last tau bytes of the previous block directly
+// in front of the current block, so the rolling loop never wraps around.
+// Memory is O(block_size + tau) regardless of the input size.
+// Returns the number of bytes read.
+template <typename window_type, typename Reader, typename F>
+inline uint64_t for_each_window(window_type const &w, Reader const &read,
+                                F const &f,
+                                uint64_t const block_size = default_block_size) {
+  using fingerprint_type = typename window_type::fingerprint_type;
+
+  uint64_t const tau = w.window_size();
+  uint64_t const block = std::max(block_size, tau);
+  std::vector<uint8_t> buffer(tau + block);
+  uint8_t *const history = buffer.data();
+  uint8_t *const data = history + tau;
+
+  // first window
+  uint64_t len = 0;
+  while (len < tau) {
+    uint64_t const r = read(data + len, block - len);
+    if (r == 0) return len;
+    len += r;
+  }
+  fingerprint_type fp = fingerprint_type();
+  for (uint64_t j = 0; j < tau; ++j) {
+    fp = w.roll_right(fp, data[j]);
+  }
+  f(0, fp);
+
+  uint64_t i = 1;
+  uint64_t j = tau;
+  while (true) {
+    // data[j - tau] is in the history if j < tau
+    for (; j < len; ++j) {
+      fp = w.roll_right(fp, data[j - tau], data[j]);
+      f(i++, fp);
+    }
+    std::memmove(history, history + len, tau);
+    len = read(data, block);
+    if (len == 0) break;
+    j = 0;
+  }
+  return i + tau - 1;
+}
+
+}  // namespace stream
+
+template <typename window_type, typename F>
+inline uint64_t stream_for_each_window(
+    window_type const &w, int const fd, F const &f,
+    uint64_t const block_size = stream::default_block_size) {
+  return stream::for_each_window(w, stream::fd_reader{fd}, f, block_size);
+}
+
+template <typename window_type, typename F>
+inline uint64_t stream_for_each_window(
+    window_type const &w, std::istream &s, F const &f,
+    uint64_t const block_size = stream::default_block_size) {
+  return stream::for_each_window(w, stream::istream_reader{s}, f, block_size);
+}
+
+}  // namespace kr_fingerprinting
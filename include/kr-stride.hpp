@@ -0,0 +1,151 @@
+#pragma once
+
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+// Rolls k bytes per step. A step computes
+//   fp * b^k + sum_m c_m * b^(k - 1 - m)
+// where the terms come from per-position byte tables and are added
+// independently of fp, so the serial dependency chain is a single
+// multiply-reduce per k bytes instead of one per byte. The fingerprints are
+// the same as the ones of byte-at-a-time rolling with the same base.
+// k is at most 8.
+template <typename window_type, uint64_t k>
+class strided_window {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t stride = k;
+
+ private:
+  static_assert(k > 0 && k <= 8);
+  using arith = window_arithmetic<window_type>;
+
+  uint64_t const window_size_;
+  fingerprint_type const base_;
+  fingerprint_type const base_k_;
+  // push_[m * 256 + c] = c * b^(k - 1 - m)
+  std::vector<fingerprint_type> push_;
+  // pop_[m * 256 + c] = -c * b^(tau + k - 1 - m)
+  std::vector<fingerprint_type> pop_;
+
+  // For the p61 fingerprints (and lanes), up to 8 table entries < 2^61 are
+  // summed without reductions: u64::mod(a * b + c) accepts any 64-bit c.
+  // The 128-bit fingerprints add with reductions.
+  constexpr static bool p61_lanes =
+      !std::is_same_v<fingerprint_type, uint128_t>;
+  constexpr static uint64_t lanes =
+      sizeof(fingerprint_type) / sizeof(uint64_t);
+
+  KRINLNFN static uint64_t &lane(fingerprint_type &fp, uint64_t const z) {
+    if constexpr (std::is_same_v<fingerprint_type, uint64_t>) {
+      return fp;
+    } else {
+      return fp.v[z];
+    }
+  }
+
+  KRINLNFN static uint64_t lane(fingerprint_type const &fp, uint64_t const z) {
+    return lane(const_cast<fingerprint_type &>(fp), z);
+  }
+
+  KRINLNFN static fingerprint_type sum(fingerprint_type a,
+                                       fingerprint_type const &b) {
+    if constexpr (p61_lanes) {
+      for (uint64_t z = 0; z < lanes; ++z) lane(a, z) += lane(b, z);
+      return a;
+    } else {
+      return arith::add(a, b);
+    }
+  }
+
+  // fp * b^k + chunk, chunk as returned by sum
+  KRINLNFN fingerprint_type step(fingerprint_type fp,
+                                 fingerprint_type const &chunk) const {
+    if constexpr (p61_lanes) {
+      for (uint64_t z = 0; z < lanes; ++z) {
+        lane(fp, z) = u64::mod(((uint128_t)lane(base_k_, z)) * lane(fp, z) +
+                               lane(chunk, z));
+      }
+      return fp;
+    } else {
+      return arith::mult_add(base_k_, fp, chunk);
+    }
+  }
+
+  // (s mod p61) + at most 8, to make room for another 8 summands
+  KRINLNFN static fingerprint_type fold(fingerprint_type s) {
+    if constexpr (p61_lanes) {
+      for (uint64_t z = 0; z < lanes; ++z) {
+        lane(s, z) = (lane(s, z) & u64::p61) + (lane(s, z) >> 61);
+      }
+    }
+    return s;
+  }
+
+ public:
+  strided_window(window_type const &w)
+      : window_size_(w.window_size()),
+        base_(w.base()),
+        base_k_(arith::power(base_, k)),
+        push_(k * 256),
+        pop_(k * 256) {
+    for (uint64_t m = 0; m < k; ++m) {
+      fingerprint_type const push_power = arith::power(base_, k - 1 - m);
+      fingerprint_type const pop_power =
+          arith::power(base_, window_size_ + k - 1 - m);
+      for (uint64_t c = 0; c < 256; ++c) {
+        push_[m * 256 + c] = arith::mult(arith::scalar(c), push_power);
+        pop_[m * 256 + c] = arith::sub(fingerprint_type(),
+                                       arith::mult(arith::scalar(c), pop_power));
+      }
+    }
+  }
+
+  // fingerprint of (string of fp) + push[0, k)
+  KRINLNFN fingerprint_type roll_right(fingerprint_type const &fp,
+                                       uint8_t const *const push) const {
+    fingerprint_type chunk = push_[push[0]];
+    for (uint64_t m = 1; m < k; ++m) {
+      chunk = sum(chunk, push_[m * 256 + push[m]]);
+    }
+    return step(fp, chunk);
+  }
+
+  // Slides the window by k bytes: pops pop[0, k) on the left, pushes
+  // push[0, k) on the right. For a window starting at t + i, these are
+  // pop = t + i and push = t + i + tau.
+  KRINLNFN fingerprint_type roll_right(fingerprint_type const &fp,
+                                       uint8_t const *const pop,
+                                       uint8_t const *const push) const {
+    fingerprint_type pushed = push_[push[0]];
+    fingerprint_type popped = pop_[pop[0]];
+    for (uint64_t m = 1; m < k; ++m) {
+      pushed = sum(pushed, push_[m * 256 + push[m]]);
+      popped = sum(popped, pop_[m * 256 + pop[m]]);
+    }
+    return step(fp, sum(fold(pushed), fold(popped)));
+  }
+
+  // Fingerprint of (string of fp) + text, k bytes per step and the
+  // remaining |text| mod k bytes one at a time. With the default fp, this is
+  // the fingerprint of the text, e.g. of a whole page or a prefix.
+  inline fingerprint_type fingerprint(std::span<uint8_t const> const text,
+                                      fingerprint_type fp = {}) const {
+    uint8_t const *const t = text.data();
+    uint64_t const n = text.size();
+    uint64_t i = 0;
+    for (; i + k <= n; i += k) fp = roll_right(fp, t + i);
+    for (; i < n; ++i) fp = arith::mult_add(base_, fp, arith::scalar(t[i]));
+    return fp;
+  }
+
+  inline fingerprint_type base() const { return base_; }
+  inline uint64_t window_size() const { return window_size_; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "kr-fingerprinting.hpp"
+
+namespace kr_fingerprinting {
+
+namespace table_cache {
+
+template <typename fingerprint_type>
+inline std::string to_hex(fingerprint_type const &fp) {
+  std::ostringstream s;
+  s << std::hex;
+  if constexpr (std::is_same_v<fingerprint_type, uint128_t>) {
+    s << (uint64_t)(fp >> 64) << '-' << (uint64_t)fp;
+  } else if constexpr (std::is_same_v<fingerprint_type, uint64_t>) {
+    s << fp;
+  } else {
+    for (uint64_t z = 0; z < fingerprint_type::size; ++z) {
+      s << (z ? "-" : "") << fp.v[z];
+    }
+  }
+  return s.str();
+}
+
+template <typename window_type>
+constexpr table_layout layout_of =
+    std::is_same_v<window_type, shift_to_type<window_type::fingerprint_bits,
+                                              table_layout::full>>
+        ? table_layout::full
+        : table_layout::compact;
+
+// file name of the table of a window in a cache directory
+template <typename window_type>
+inline std::string file_name(std::string const &directory,
+                             uint64_t const window_size,
+                             typename window_type::fingerprint_type const &base) {
+  return directory + "/kr-" + std::to_string(window_type::fingerprint_bits) +
+         (layout_of<window_type> == table_layout::full ? "-full-"
+                                                       : "-compact-") +
+         std::to_string(window_size) + "-" + to_hex(base) + ".table";
+}
+
+// The windows of one type currently alive, keyed by (window size, base), or
+// build() if there is none. There is one cache per window type, shared by all
+// builders (with or without a directory). Only weak references are held: a
+// window is freed when its last user is gone, and rebuilt by the next request.
+template <typename window_type>
+std::shared_ptr<window_type const> get_or_build(
+    uint64_t const window_size,
+    typename window_type::fingerprint_type const &base,
+    std::function<std::shared_ptr<window_type const>()> const &build) {
+  using key_type = std::pair<uint64_t, typename window_type::fingerprint_type>;
+  static std::mutex mutex;
+  static std::map<key_type, std::weak_ptr<window_type const>> windows;
+
+  std::lock_guard<std::mutex> const lock(mutex);
+  auto &cached = windows[key_type(window_size, base)];
+  if (auto existing = cached.lock()) return existing;
+  std::shared_ptr<window_type const> w = build();
+  cached = w;
+  return w;
+}
+
+}  // namespace table_cache
+
+// Process-wide cache of windows, keyed by (shift, layout, window size, base).
+// All callers asking for the same window share one immutable instance and
+// thus one table. Bases are compared as given, pass reduced bases (e.g.
+// w.base() of another window) to share windows built from equivalent ones.
+template <typename window_type>
+std::shared_ptr<window_type const> shared_window(
+    uint64_t const window_size,
+    typename window_type::fingerprint_type const &base) {
+  return table_cache::get_or_build<window_type>(window_size, base, [&] {
+    return std::make_shared<window_type const>(window_size, base);
+  });
+}
+
+// As above, but the table is also cached in a directory: it is loaded from
+// there if present, otherwise built and saved (failures to save are
+// ignored). Useful for deterministic seeds, where the same windows are built
+// by many processes.
+template <typename window_type>
+std::shared_ptr<window_type const> shared_window(
+    uint64_t const window_size,
+    typename window_type::fingerprint_type const &base,
+    std::string const &directory) {
+  return table_cache::get_or_build<window_type>(window_size, base, [&] {
+    std::string const path =
+        table_cache::file_name<window_type>(directory, window_size, base);
+    if (std::ifstream in(path, std::ios::binary); in) {
+      try {
+        return std::make_shared<window_type const>(window_size, base, in);
+      } catch (std::runtime_error const &) {
+        // stale or truncated file, rebuilt below
+      }
+    }
+    auto w = std::make_shared<window_type const>(window_size, base);
+    // concurrent processes only ever see complete files
+    std::string const tmp = path + ".tmp" + std::to_string(::getpid());
+    try {
+      std::ofstream out(tmp, std::ios::binary);
+      w->save_table(out);
+      out.close();
+      if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+      }
+    } catch (std::runtime_error const &) {
+      std::remove(tmp.c_str());
+    }
+    return w;
+  });
+}
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "kr-arithmetic.hpp"
+
+namespace kr_fingerprinting {
+
+// Fingerprints of windows that grow, shrink and slide in both directions.
+// Like the windows, a variable_window is immutable and the fingerprints (and
+// lengths) are passed in and returned: fp is the fingerprint of a string S,
+// length = |S|. Strings can be extended or shrunk at either end in O(1):
+//   push_right: S + c   = fp * b + c
+//   pop_right:  S - c   = (fp - c) * b^-1
+//   push_left:  c + S   = fp + c * b^|S|
+//   pop_left:   S - c   = fp - c * b^(|S| - 1)
+// using b^-1 and a cache of the powers b^0 ... b^max_length of the window's
+// base. Longer strings fall back to computing the power. The fingerprints
+// are the ones of the window, windows of its fixed size can be rolled right
+// with its lookup table and rolled left with two compact tables.
+// The window must outlive the variable_window.
+template <typename window_type>
+class variable_window {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t fingerprint_bits = window_type::fingerprint_bits;
+
+ private:
+  using arith = window_arithmetic<window_type>;
+
+  window_type const *const window_;
+  uint64_t const window_size_;
+  fingerprint_type const base_;
+  fingerprint_type const inverse_base_;
+  // powers_[i] = b^i for i <= max_length
+  std::vector<fingerprint_type> powers_;
+  // roll_left: left_push_[c] = c * b^(tau - 1), right_pop_[c] = -c * b^-1
+  std::vector<fingerprint_type> left_push_;
+  std::vector<fingerprint_type> right_pop_;
+
+  KRINLNFN fingerprint_type times(fingerprint_type const &fp,
+                                  uint64_t const c) const {
+    return arith::mult(arith::scalar(c), fp);
+  }
+
+ public:
+  // max_length = 0 caches the powers up to the window size
+  variable_window(window_type const &w, uint64_t const max_length = 0)
+      : window_(&w),
+        window_size_(w.window_size()),
+        base_(w.base()),
+        inverse_base_(arith::inverse(base_)),
+        powers_(std::max(max_length, window_size_) + 1),
+        left_push_(256),
+        right_pop_(256) {
+    powers_[0] = arith::scalar(1);
+    for (uint64_t i = 1; i < powers_.size(); ++i) {
+      powers_[i] = arith::mult(powers_[i - 1], base_);
+    }
+    fingerprint_type const left_power =
+        power(window_size_ > 0 ? window_size_ - 1 : 0);
+    for (uint64_t c = 0; c < 256; ++c) {
+      left_push_[c] = times(left_power, c);
+      right_pop_[c] = arith::sub(fingerprint_type(), times(inverse_base_, c));
+    }
+  }
+
+  // b^i, O(1) for i <= max_length
+  KRINLNFN fingerprint_type power(uint64_t const i) const {
+    if (i < powers_.size()) [[likely]]
+      return powers_[i];
+    return arith::power(base_, i);
+  }
+
+  template <ByteType T>
+  KRINLNFN fingerprint_type push_right(fingerprint_type const &fp,
+                                       T const c) const {
+    return arith::mult_add(base_, fp, arith::scalar(c));
+  }
+
+  // c is the last byte of the string
+  template <ByteType T>
+  KRINLNFN fingerprint_type pop_right(fingerprint_type const &fp,
+                                      T const c) const {
+    return arith::mult(arith::sub(fp, arith::scalar(c)), inverse_base_);
+  }
+
+  // length of the string before the push
+  template <ByteType T>
+  KRINLNFN fingerprint_type push_left(fingerprint_type const &fp,
+                                      uint64_t const length, T const c) const {
+    return arith::add(fp, times(power(length), c));
+  }
+
+  // c is the first byte of the string, length before the pop (>= 1)
+  template <ByteType T>
+  KRINLNFN fingerprint_type pop_left(fingerprint_type const &fp,
+                                     uint64_t const length, T const c) const {
+    return arith::sub(fp, times(power(length - 1), c));
+  }
+
+  // window of the fixed size starting at i -> starting at i + 1
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_right(fingerprint_type const &fp,
+                                       T const pop_left,
+                                       T const push_right) const {
+    return window_->roll_right(fp, pop_left, push_right);
+  }
+
+  // Window of the fixed size starting at i + 1 -> starting at i: pops
+  // t[i + tau] on the right and pushes t[i] on the left,
+  //   fp' = fp * b^-1 - t[i + tau] * b^-1 + t[i] * b^(tau - 1)
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_left(fingerprint_type const &fp,
+                                      T const pop_right,
+                                      T const push_left) const {
+    return arith::mult_add(
+        inverse_base_, fp,
+        arith::add(left_push_[push_left], right_pop_[pop_right]));
+  }
+
+  inline window_type const &window() const { return *window_; }
+  inline fingerprint_type base() const { return base_; }
+  inline fingerprint_type inverse_base() const { return inverse_base_; }
+  inline uint64_t window_size() const { return window_size_; }
+  inline uint64_t max_length() const { return powers_.size() - 1; }
+};
+
+}  // namespace kr_fingerprinting
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "kr-table-cache.hpp"
+
+namespace kr_fingerprinting {
+
+// Copyable, assignable reference to a shared immutable window. The windows
+// themselves have const members and inline tables of up to several MiB, so
+// they can neither be assigned nor cheaply copied; a handle is two pointers
+// plus the base and window size, and copies of it (e.g. one per worker
+// thread, or as elements of a std::vector) all use the same table. Handles
+// have the interface of the windows and can be passed to every algorithm
+// taking a window_type.
+template <typename window_type>
+class window_handle {
+ public:
+  using fingerprint_type = typename window_type::fingerprint_type;
+  constexpr static uint64_t fingerprint_bits = window_type::fingerprint_bits;
+
+ private:
+  std::shared_ptr<window_type const> window_;
+  fingerprint_type base_ = fingerprint_type();
+  uint64_t window_size_ = 0;
+
+ public:
+  // empty handle, only to be assigned to
+  window_handle() = default;
+
+  explicit window_handle(std::shared_ptr<window_type const> window)
+      : window_(std::move(window)),
+        base_(window_->base()),
+        window_size_(window_->window_size()) {}
+
+  // the window with a random base, owned by this handle and its copies
+  explicit window_handle(uint64_t const window_size)
+      : window_handle(std::make_shared<window_type const>(window_size)) {}
+
+  // the window of the process-wide cache, see shared_window
+  window_handle(uint64_t const window_size, fingerprint_type const &base)
+      : window_handle(shared_window<window_type>(window_size, base)) {}
+
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_right(fingerprint_type const &fp,
+                                       T const pop_left,
+                                       T const push_right) const {
+    return window_->roll_right(fp, pop_left, push_right);
+  }
+
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_right(fingerprint_type const &fp,
+                                       T const push_right) const {
+    return window_->roll_right(fp, push_right);
+  }
+
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_right_lazy(fingerprint_type const &fp,
+                                            T const pop_left,
+                                            T const push_right) const {
+    return window_->roll_right_lazy(fp, pop_left, push_right);
+  }
+
+  template <ByteType T>
+  KRINLNFN fingerprint_type roll_right_lazy(fingerprint_type const &fp,
+                                            T const push_right) const {
+    return window_->roll_right_lazy(fp, push_right);
+  }
+
+  KRINLNFN static fingerprint_type canonicalize(fingerprint_type const &fp) {
+    return window_type::canonicalize(fp);
+  }
+
+  inline window_type const &window() const { return *window_; }
+  inline std::shared_ptr<window_type const> const &shared() const {
+    return window_;
+  }
+  inline explicit operator bool() const { return window_ != nullptr; }
+
+  inline fingerprint_type base() const { return base_; }
+  inline uint64_t window_size() const { return window_size_; }
+  inline uint64_t bits() const { return fingerprint_bits; }
+  inline double collision_rate() const { return window_->collision_rate(); }
+};
+
+template <uint64_t shift, table_layout layout = table_layout::full>
+using sliding_window_handle = window_handle<sliding_window<shift, layout>>;
+
+}  // namespace kr_fingerprinting
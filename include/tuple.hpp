@@ -13,6 +13,17 @@ struct tuple {
   constexpr static uint64_t size = x;
   uint64_t v[x] = {};
 
+  // Lanes [2i, 2i + 2) as one 128-bit value. memcpy instead of a pointer
+  // cast, which would break strict aliasing with the stores to v (e.g. when
+  // tuples are moved by std::sort); it compiles to the same loads.
+  __attribute__((always_inline)) inline static unsigned __int128 half(
+      tuple const &t, uint64_t const i) {
+    __extension__ using uint128_t = unsigned __int128;
+    uint128_t h;
+    std::memcpy(&h, t.v + 2 * i, sizeof(h));
+    return h;
+  }
+
   template <typename T>
   tuple &apply(T const &t) {
     for (uint64_t z = 0; z < x; ++z) v[z] = t(v[z]);
@@ -30,18 +41,12 @@ struct tuple {
       return v[0] == o.v[0];
 
     } else if constexpr (x == 2) {
-      return (*((uint128_t const *)((void const *)this))) ==
-             (*((uint128_t const *)((void const *)&o)));
+      return half(*this, 0) == half(o, 0);
 
     } else if constexpr (x == 3) {
-      return ((*((uint128_t const *)((void const *)this))) ==
-              (*((uint128_t const *)((void const *)&o)))) &&
-             (v[2] == o.v[2]);
+      return (half(*this, 0) == half(o, 0)) && (v[2] == o.v[2]);
     } else if constexpr (x == 4) {
-      return ((*((uint128_t const *)((void const *)this))) ==
-              (*((uint128_t const *)((void const *)&o)))) &&
-             ((*(((uint128_t const *)((void const *)this)) + 1)) ==
-              (*(((uint128_t const *)((void const *)&o)) + 1)));
+      return (half(*this, 0) == half(o, 0)) && (half(*this, 1) == half(o, 1));
     } else {
       return std::memcmp(this, &o, sizeof(tuple)) == 0;
     }
@@ -58,18 +63,12 @@ struct tuple {
       return v[0] != o.v[0];
 
     } else if constexpr (x == 2) {
-      return (*((uint128_t const *)((void const *)this))) !=
-             (*((uint128_t const *)((void const *)&o)));
+      return half(*this, 0) != half(o, 0);
 
     } else if constexpr (x == 3) {
-      return ((*((uint128_t const *)((void const *)this))) !=
-              (*((uint128_t const *)((void const *)&o)))) ||
-             (v[2] != o.v[2]);
+      return (half(*this, 0) != half(o, 0)) || (v[2] != o.v[2]);
     } else if constexpr (x == 4) {
-      return ((*((uint128_t const *)((void const *)this))) !=
-              (*((uint128_t const *)((void const *)&o)))) ||
-             ((*(((uint128_t const *)((void const *)this)) + 1)) !=
-              (*(((uint128_t const *)((void const *)&o)) + 1)));
+      return (half(*this, 0) != half(o, 0)) || (half(*this, 1) != half(o, 1));
     } else {
       return std::memcmp(this, &o, sizeof(tuple)) == 0;
     }
@@ -86,23 +85,16 @@ struct tuple {
       return v[0] < o.v[0];
 
     } else if constexpr (x == 2) {
-      return (*((uint128_t const *)((void const *)this))) <
-             (*((uint128_t const *)((void const *)&o)));
+      return half(*this, 0) < half(o, 0);
 
     } else if constexpr (x == 3) {
-      return ((*((uint128_t const *)((void const *)this))) <
-              (*((uint128_t const *)((void const *)&o)))) ||
-             (((*((uint128_t const *)((void const *)this))) ==
-               (*((uint128_t const *)((void const *)&o)))) &&
-              (v[2] < o.v[2]));
+      return (half(*this, 0) < half(o, 0)) ||
+             ((half(*this, 0) == half(o, 0)) && (v[2] < o.v[2]));
 
     } else if constexpr (x == 4) {
-      return ((*((uint128_t const *)((void const *)this))) <
-              (*((uint128_t const *)((void const *)&o)))) ||
-             (((*((uint128_t const *)((void const *)this))) ==
-               (*((uint128_t const *)((void const *)&o)))) &&
-              ((*(((uint128_t const *)((void const *)this)) + 1)) <
-               (*(((uint128_t const *)((void const *)&o)) + 1))));
+      return (half(*this, 0) < half(o, 0)) ||
+             ((half(*this, 0) == half(o, 0)) &&
+              (half(*this, 1) < half(o, 1)));
 
     } else {
       return std::memcmp(this, &o, sizeof(tuple)) < 0;
@@ -120,23 +112,16 @@ struct tuple {
       return v[0] <= o.v[0];
 
     } else if constexpr (x == 2) {
-      return (*((uint128_t const *)((void const *)this))) <=
-             (*((uint128_t const *)((void const *)&o)));
+      return half(*this, 0) <= half(o, 0);
 
     } else if constexpr (x == 3) {
-      return ((*((uint128_t const *)((void const *)this))) <
-              (*((uint128_t const *)((void const *)&o)))) ||
-             (((*((uint128_t const *)((void const *)this))) ==
-               (*((uint128_t const *)((void const *)&o)))) &&
-              (v[2] <= o.v[2]));
+      return (half(*this, 0) < half(o, 0)) ||
+             ((half(*this, 0) == half(o, 0)) && (v[2] <= o.v[2]));
 
     } else if constexpr (x == 4) {
-      return ((*((uint128_t const *)((void const *)this))) <
-              (*((uint128_t const *)((void const *)&o)))) ||
-             (((*((uint128_t const *)((void const *)this))) ==
-               (*((uint128_t const *)((void const *)&o)))) &&
-              ((*(((uint128_t const *)((void const *)this)) + 1)) <=
-               (*(((uint128_t const *)((void const *)&o)) + 1))));
+      return (half(*this, 0) < half(o, 0)) ||
+             ((half(*this, 0) == half(o, 0)) &&
+              (half(*this, 1) <= half(o, 1)));
 
     } else {
       return std::memcmp(this, &o, sizeof(tuple)) <= 0;
@@ -1,15 +1,40 @@
+#include <unistd.h>
+
+#include <array>
 #include <chrono>
 #include <concepts>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <optional>
 #include <random>
 #include <sstream>
+#include <unordered_set>
 
 //#define inline __attribute__((always_inline)) inline
 
+#include "include/kr-algebra.hpp"
+#include "include/kr-batch.hpp"
+#include "include/kr-bulk.hpp"
+#include "include/kr-chunking.hpp"
+#include "include/kr-delta.hpp"
 #include "include/kr-fingerprinting.hpp"
 #include "include/kr-fingerprinting128.hpp"
+#include "include/kr-hash.hpp"
+#include "include/kr-minhash.hpp"
+#include "include/kr-minimizers.hpp"
+#include "include/kr-mmap.hpp"
+#include "include/kr-multi-length.hpp"
+#include "include/kr-parallel.hpp"
+#include "include/kr-pattern-search.hpp"
+#include "include/kr-prefix-index.hpp"
+#include "include/kr-repeats.hpp"
+#include "include/kr-stream.hpp"
+#include "include/kr-stride.hpp"
+#include "include/kr-variable-window.hpp"
+#include "include/kr-window-handle.hpp"
 
 #include "../rk-fingerprint/rolling_hash/rk_prime.hpp"
 
@@ -36,7 +61,8 @@ struct {
 } timer;
 
 template <typename window_type>
-KRINLNFN void mainp(std::vector<uint8_t> const &string, window_type const &w) {
+KRINLNFN void mainp(std::span<uint8_t const> const string, window_type const &w,
+                    std::string const &name = "FP-") {
   uint64_t const n = string.size();
   uint64_t const tau = w.window_size();
 
@@ -53,7 +79,7 @@ KRINLNFN void mainp(std::vector<uint8_t> const &string, window_type const &w) {
 
   using uintX_t = window_type::fingerprint_type;
 
-  std::string s = std::string("FP-") + std::to_string(w.bits());
+  std::string s = name + std::to_string(w.bits());
   std::cout << s << " start!" << std::endl;
   std::cout << s << " collision rate: " << col(w.collision_rate()) << std::endl;
   timer.start();
@@ -82,7 +108,7 @@ KRINLNFN void mainp(std::vector<uint8_t> const &string, window_type const &w) {
 }
 
 template <typename window_type>
-KRINLNFN void mainp1(std::vector<uint8_t> const &string, window_type const &w) {
+KRINLNFN void mainp1(std::span<uint8_t const> const string, window_type const &w) {
   uint64_t const n = string.size();
   uint64_t const tau = w.window_size();
 
@@ -122,11 +148,1140 @@ KRINLNFN void mainp1(std::vector<uint8_t> const &string, window_type const &w) {
   std::cout << s << " correct=" << (fptest == fp) << std::endl;
 }
 
+// 1 MiB of 100 non-zero bytes followed by zeros. The zero windows rolled in
+// after the non-zero bytes hold p in the p61 lanes, seeded ones hold 0.
+std::vector<uint8_t> zero_tail() {
+  std::vector<uint8_t> text(1 << 20, 0);
+  for (uint64_t i = 0; i < 100; ++i) text[i] = 1 + i;
+  return text;
+}
+
+// every window of fingerprint_windows (in blocks of 64 Ki windows) vs the
+// canonical fingerprints of one sequential roll
+template <typename window_type, uint64_t chains>
+KRINLNFN bool check_bulk(std::span<uint8_t const> const string,
+                         window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  uint64_t const n = string.size();
+  uint64_t const tau = w.window_size();
+  std::vector<uintX_t> out(1ULL << 16);
+  uint64_t const block = out.size();
+  bool correct = true;
+  uintX_t fp = uintX_t();
+  for (uint64_t i = 0; i < std::min(tau, n); ++i) {
+    fp = w.roll_right(fp, string[i]);
+  }
+  for (uint64_t i = 0; i + tau <= n; i += block) {
+    uint64_t const len = std::min(block + tau - 1, n - i);
+    fingerprint_windows<window_type, chains>(w, string.subspan(i, len),
+                                             std::span<uintX_t>(out));
+    for (uint64_t j = 0; j + tau <= len; ++j) {
+      if (i + j > 0) {
+        fp = w.roll_right(fp, string[i + j - 1], string[i + j - 1 + tau]);
+      }
+      correct &= (out[j] == window_type::canonicalize(fp));
+    }
+  }
+  return correct;
+}
+
+// fingerprint_windows with the default number of chains vs a single chain
+template <typename window_type>
+KRINLNFN void mainp_bulk(std::span<uint8_t const> const string,
+                         window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  constexpr uint64_t chains = bulk::default_chains<uintX_t>;
+  uint64_t const n = string.size();
+  uint64_t const tau = w.window_size();
+
+  // blocks of windows are written to a reusable buffer
+  std::vector<uintX_t> out(1ULL << 16);
+  uint64_t const block = out.size();
+  auto const run = [&]<uint64_t k>() {
+    for (uint64_t i = 0; i + tau <= n; i += block) {
+      uint64_t const len = std::min(block + tau - 1, n - i);
+      fingerprint_windows<window_type, k>(w, string.subspan(i, len),
+                                          std::span<uintX_t>(out));
+    }
+  };
+
+  std::string s = std::string("FP-BULK-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  run.template operator()<chains>();
+  auto time = timer.stop();
+  std::cout << s << " chains-" << chains << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, n) << "mibs" << std::endl;
+  timer.start();
+  run.template operator()<1>();
+  time = timer.stop();
+  std::cout << s << " chains-1 time: " << time << "[ms]"
+            << " = " << timer.mibs(time, n) << "mibs" << std::endl;
+
+  std::vector<uint8_t> const zeros = zero_tail();
+  bool const correct =
+      check_bulk<window_type, chains>(string, w) &&
+      check_bulk<window_type, chains>(zeros, w) &&
+      check_bulk<window_type, 3>(zeros, w);
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// parallel_fingerprint_windows and parallel_for_each_window vs the canonical
+// fingerprints of one sequential roll, over a 4 MiB prefix and over zero_tail
+// (a worker seeds a zero window as 0 where the sequential roll holds p), for
+// several thread counts and for prefixes with fewer windows than threads
+template <typename window_type>
+KRINLNFN void mainp_parallel(std::span<uint8_t const> const string,
+                             window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  uint64_t const tau = w.window_size();
+  std::vector<uint8_t> const zeros = zero_tail();
+
+  std::string s = std::string("FP-PARALLEL-") + std::to_string(w.bits());
+  bool correct = true;
+  for (auto text : {string, std::span<uint8_t const>(zeros)}) {
+    text = text.first(std::min<uint64_t>(text.size(), 4 << 20));
+    if (text.size() < tau) continue;
+
+    std::vector<uintX_t> expected(text.size() - tau + 1);
+    uintX_t fp = uintX_t();
+    for (uint64_t i = 0; i < tau; ++i) fp = w.roll_right(fp, text[i]);
+    expected[0] = window_type::canonicalize(fp);
+    for (uint64_t i = 1; i < expected.size(); ++i) {
+      fp = w.roll_right(fp, text[i - 1], text[i - 1 + tau]);
+      expected[i] = window_type::canonicalize(fp);
+    }
+
+    for (uint64_t const threads : {1, 3, 8}) {
+      for (uint64_t const n : {text.size(), tau + 1, tau - 1}) {
+        if (n > text.size()) continue;
+        auto const prefix = text.first(n);
+        uint64_t const windows = (n >= tau) ? n - tau + 1 : 0;
+        std::vector<uintX_t> out(windows + 1, uintX_t());
+        parallel_fingerprint_windows(w, prefix, std::span<uintX_t>(out),
+                                     threads);
+        correct &= std::equal(expected.begin(), expected.begin() + windows,
+                              out.begin());
+        // the window after the last one is not written
+        correct &= (out[windows] == uintX_t());
+
+        std::vector<uint8_t> seen(windows, 0);
+        std::vector<uintX_t> each(windows);
+        parallel_for_each_window(
+            w, prefix,
+            [&](uint64_t const i, uintX_t const &fp) {
+              ++seen[i];
+              each[i] = fp;
+            },
+            threads);
+        correct &= std::equal(expected.begin(), expected.begin() + windows,
+                              each.begin());
+        correct &= std::all_of(seen.begin(), seen.end(),
+                               [](uint8_t const c) { return c == 1; });
+      }
+    }
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// parallel_prefix_fingerprints (both overloads) vs the sequential prefix
+// fingerprints of a 4 MiB prefix, for several thread counts and lengths
+template <typename window_type>
+KRINLNFN void mainp_parallel_prefix(std::span<uint8_t const> const string,
+                                    window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  auto const text = string.first(std::min<uint64_t>(string.size(), 4 << 20));
+
+  std::vector<uintX_t> expected(text.size());
+  uintX_t fp = uintX_t();
+  for (uint64_t i = 0; i < text.size(); ++i) {
+    fp = w.roll_right(fp, text[i]);
+    expected[i] = window_type::canonicalize(fp);
+  }
+
+  std::string s = std::string("FP-PREFIX-") + std::to_string(w.bits());
+  bool correct = true;
+  for (uint64_t const threads : {1, 2, 3, 8, 64}) {
+    for (uint64_t const n : {text.size(), text.size() / 3 + 1, uint64_t(5)}) {
+      if (n > text.size()) continue;
+      auto const prefix = text.first(n);
+      std::vector<uintX_t> out(n);
+      parallel_prefix_fingerprints(w, prefix, std::span<uintX_t>(out), threads);
+      std::vector<uint8_t> seen(n, 0);
+      std::vector<uintX_t> each(n);
+      parallel_prefix_fingerprints(
+          w, prefix,
+          [&](uint64_t const i, uintX_t const &fp) {
+            ++seen[i];
+            each[i] = fp;
+          },
+          threads);
+      for (uint64_t i = 0; i < n; ++i) {
+        correct &= (window_type::canonicalize(out[i]) == expected[i]);
+        correct &= (window_type::canonicalize(each[i]) == expected[i]);
+        correct &= (seen[i] == 1);
+      }
+    }
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// stream_for_each_window vs a sequential roll over a 256 KiB prefix, read
+// in short reads of 1 to 7 bytes into blocks of tau, 17 and 4096 bytes (so
+// windows cross the block boundaries), from a std::istream, for prefixes
+// shorter than tau, and with a stream that fails with badbit
+template <typename window_type>
+KRINLNFN void mainp_stream(std::span<uint8_t const> const string,
+                           window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  uint64_t const tau = w.window_size();
+  auto const text = string.first(std::min<uint64_t>(string.size(), 256 << 10));
+
+  std::vector<uintX_t> expected;
+  uintX_t fp = uintX_t();
+  for (uint64_t i = 0; i < text.size(); ++i) {
+    if (i < tau) {
+      fp = w.roll_right(fp, text[i]);
+    } else {
+      fp = w.roll_right(fp, text[i - tau], text[i]);
+    }
+    if (i + 1 >= tau) expected.push_back(fp);
+  }
+
+  std::mt19937_64 g(w.bits());
+  struct short_reader {
+    std::span<uint8_t const> mutable rest;
+    std::mt19937_64 &g;
+
+    uint64_t operator()(uint8_t *const data, uint64_t const size) const {
+      uint64_t const r =
+          std::min<uint64_t>({size, rest.size(), 1 + g() % 7});
+      std::memcpy(data, rest.data(), r);
+      rest = rest.subspan(r);
+      return r;
+    }
+  };
+
+  std::string s = std::string("STREAM-") + std::to_string(w.bits());
+  bool correct = true;
+  auto const check = [&](uint64_t const n, auto const &run) {
+    uint64_t next = 0;
+    uint64_t const bytes = run([&](uint64_t const i, uintX_t const &fp) {
+      correct &= (i == next++ && fp == expected[i]);
+    });
+    correct &= (bytes == n && next == ((n >= tau) ? n - tau + 1 : 0));
+  };
+  for (uint64_t const n : {text.size(), tau - 1, uint64_t(0)}) {
+    if (n > text.size()) continue;
+    auto const prefix = text.first(n);
+    for (uint64_t const block : {uint64_t(1), uint64_t(17), uint64_t(4096)}) {
+      check(n, [&](auto const &f) {
+        return stream::for_each_window(w, short_reader{prefix, g}, f, block);
+      });
+    }
+    std::istringstream in(std::string(prefix.begin(), prefix.end()));
+    check(n, [&](auto const &f) {
+      return stream_for_each_window(w, in, f, 4096);
+    });
+  }
+
+  // a stream buffer that fails after the first bytes sets badbit
+  struct failing_buffer : std::streambuf {
+    char bytes[3] = {'a', 'b', 'c'};
+    bool served = false;
+    int_type underflow() override {
+      if (served) throw std::runtime_error("device error");
+      served = true;
+      setg(bytes, bytes, bytes + 3);
+      return traits_type::to_int_type(bytes[0]);
+    }
+  };
+  failing_buffer buffer;
+  std::istream failing(&buffer);
+  try {
+    stream_for_each_window(w, failing, [](uint64_t, uintX_t const &) {});
+    correct = false;
+  } catch (std::ios_base::failure const &) {
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// pattern_matcher vs std::search for every pattern, with and without
+// verification: windows of the text, an equal pattern twice (the first id is
+// reported), a zero pattern that also occurs after non-zero bytes, and random
+// patterns
+template <typename window_type>
+KRINLNFN void mainp_patterns(std::span<uint8_t const> const string,
+                             window_type const &w) {
+  uint64_t const tau = w.window_size();
+  auto const head = string.first(std::min<uint64_t>(string.size(), 256 << 10));
+  std::vector<uint8_t> text(head.begin(), head.end());
+  text.insert(text.end(), 37, 0xab);
+  text.insert(text.end(), 3 * tau, 0);
+  text.insert(text.end(), 37, 0xab);
+  if (text.size() < tau) return;
+
+  std::mt19937_64 g(w.bits());
+  std::vector<uint8_t> patterns;
+  for (uint64_t k = 0; k < 64; ++k) {
+    uint64_t const i = g() % (text.size() - tau + 1);
+    patterns.insert(patterns.end(), text.begin() + i, text.begin() + i + tau);
+  }
+  patterns.insert(patterns.end(), patterns.begin(), patterns.begin() + tau);
+  patterns.insert(patterns.end(), tau, 0);
+  for (uint64_t k = 0; k < 8 * tau; ++k) patterns.push_back(g());
+  uint64_t const count = patterns.size() / tau;
+
+  // (position, first id of an equal pattern)
+  std::vector<std::pair<uint64_t, uint64_t>> expected;
+  for (uint64_t id = 0; id < count; ++id) {
+    auto const pattern = patterns.begin() + id * tau;
+    bool first = true;
+    for (uint64_t other = 0; other < id; ++other) {
+      first &= !std::equal(pattern, pattern + tau,
+                           patterns.begin() + other * tau);
+    }
+    if (!first) continue;
+    for (auto it = text.begin();
+         (it = std::search(it, text.end(), pattern, pattern + tau)) !=
+         text.end();
+         ++it) {
+      expected.emplace_back(it - text.begin(), id);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  std::string s = std::string("PATTERNS-") + std::to_string(w.bits());
+  bool correct = true;
+  for (bool const verify : {false, true}) {
+    pattern_matcher<window_type> const matcher(w, patterns, verify);
+    std::vector<std::pair<uint64_t, uint64_t>> found;
+    uint64_t const matches = matcher.search(
+        text, [&](uint64_t const i, uint64_t const id) {
+          found.emplace_back(i, id);
+        });
+    correct &= (found == expected && matches == expected.size());
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// multi_length_scanner vs one sliding window per length over a 64 KiB prefix
+// followed by zeros, including lengths larger than the text, with the
+// windows' own bases and with a shared base
+template <uint64_t shift>
+KRINLNFN void mainp_multi_length(std::span<uint8_t const> const string) {
+  using window_type = sliding_window_handle<shift>;
+  using uintX_t = window_type::fingerprint_type;
+  auto const head = string.first(std::min<uint64_t>(string.size(), 64 << 10));
+  std::vector<uint8_t> text(head.begin(), head.end());
+  text.insert(text.end(), 4096, 0);
+  uint64_t const n = text.size();
+
+  std::vector<uint64_t> const taus = {1, 7, 64, 1000, 4096, n, n + 5};
+  std::vector<window_type> windows;
+  std::vector<window_type const *> pointers;
+  for (uint64_t const tau : taus) windows.emplace_back(tau);
+  for (auto const &w : windows) pointers.push_back(&w);
+  std::vector<window_type> shared;
+  for (uint64_t const tau : taus) shared.emplace_back(tau, windows[0].base());
+
+  auto const check = [&](std::vector<window_type> const &ws,
+                         multi_length_scanner<window_type> const &scanner) {
+    std::vector<std::vector<uintX_t>> expected(ws.size());
+    for (uint64_t k = 0; k < ws.size(); ++k) {
+      uint64_t const tau = ws[k].window_size();
+      uintX_t fp = uintX_t();
+      for (uint64_t i = 0; i < n; ++i) {
+        if (i < tau) {
+          fp = ws[k].roll_right(fp, text[i]);
+        } else {
+          fp = ws[k].roll_right(fp, text[i - tau], text[i]);
+        }
+        if (i + 1 >= tau) expected[k].push_back(window_type::canonicalize(fp));
+      }
+    }
+    std::vector<std::vector<uintX_t>> found(ws.size());
+    bool ordered = true;
+    uint64_t last_end = 0;
+    uint64_t last_k = 0;
+    scanner.scan(text, [&](uint64_t const k, uint64_t const i,
+                           uintX_t const &fp) {
+      uint64_t const end = i + ws[k].window_size();
+      ordered &= (end > last_end || (end == last_end && k >= last_k));
+      last_end = end;
+      last_k = k;
+      ordered &= (i == found[k].size());
+      found[k].push_back(window_type::canonicalize(fp));
+    });
+    return ordered && found == expected;
+  };
+
+  std::string s = std::string("MULTI-LENGTH-") + std::to_string(shift);
+  bool correct = check(
+      windows, multi_length_scanner<window_type>(
+                   std::span<window_type const *const>(pointers)));
+  correct &= check(shared, multi_length_scanner<window_type>(
+                               std::span<uint64_t const>(taus),
+                               windows[0].base()));
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// prefix_index vs direct rolls and a naive LCE on three copies of a prefix
+// of the input (the second with one byte flipped), for sample = 1 and for
+// samples whose grid the ranges start and end off of
+template <typename window_type>
+KRINLNFN void mainp_prefix_index(std::span<uint8_t const> const string,
+                                 window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  auto const copy = string.first(std::min<uint64_t>(string.size(), 16 << 10));
+  if (copy.empty()) return;
+  uint64_t const m = copy.size();
+  std::vector<uint8_t> text;
+  for (uint64_t k = 0; k < 3; ++k) {
+    text.insert(text.end(), copy.begin(), copy.end());
+  }
+  text[m + m / 2] ^= 1;
+  uint64_t const n = text.size();
+
+  auto const direct = [&](uint64_t const i, uint64_t const j) {
+    uintX_t fp = uintX_t();
+    for (uint64_t k = i; k < j; ++k) fp = w.roll_right(fp, text[k]);
+    return window_type::canonicalize(fp);
+  };
+  auto const naive_lce = [&](uint64_t const i, uint64_t const j) {
+    uint64_t l = 0;
+    while (std::max(i, j) + l < n && text[i + l] == text[j + l]) ++l;
+    return l;
+  };
+
+  std::string s = std::string("PREFIX-INDEX-") + std::to_string(w.bits());
+  std::mt19937_64 g(w.bits());
+  bool correct = true;
+  for (uint64_t const sample : {1, 7, 64}) {
+    prefix_index<window_type> const index(w, text, sample, 3);
+
+    std::vector<std::pair<uint64_t, uint64_t>> ranges = {
+        {0, 0}, {0, n}, {n, n}, {1, n - 1}, {sample + 1, 3 * sample - 1}};
+    for (uint64_t k = 0; k < 2000; ++k) {
+      uint64_t const i = g() % (n + 1);
+      ranges.emplace_back(i, std::min(n, i + g() % 2048));
+    }
+    for (auto const &[i, j] : ranges) {
+      if (j > n) continue;
+      correct &= (window_type::canonicalize(index.substring_fp(i, j)) ==
+                  direct(i, j));
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> pairs = {
+        {0, 0}, {0, m}, {0, 2 * m}, {m, 2 * m}, {n - 1, 0}};
+    for (uint64_t k = 0; k < 300; ++k) {
+      uint64_t const i = g() % m;
+      pairs.emplace_back(i, i + m);
+      pairs.emplace_back(i + 2 * m, i);
+      pairs.emplace_back(i, g() % n);
+    }
+    for (auto const &[i, j] : pairs) {
+      correct &= (index.lce(i, j) == naive_lce(i, j));
+    }
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// fingerprint_algebra vs direct rolls: concat and both strips on random
+// pieces A, B of the input (shorter and longer than the cached powers), and
+// repeat on A^k
+template <typename window_type>
+KRINLNFN void mainp_algebra(std::span<uint8_t const> const string,
+                            window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  if (string.empty()) return;
+  fingerprint_algebra<window_type> const algebra(w);
+
+  auto const direct = [&](std::vector<uint8_t> const &t) {
+    uintX_t fp = uintX_t();
+    for (uint8_t const c : t) fp = w.roll_right(fp, c);
+    return window_type::canonicalize(fp);
+  };
+  std::mt19937_64 g(w.bits());
+  auto const piece = [&](uint64_t const max_len) {
+    uint64_t const i = g() % string.size();
+    uint64_t const len = std::min(g() % (max_len + 1), string.size() - i);
+    return std::vector<uint8_t>(string.begin() + i, string.begin() + i + len);
+  };
+
+  auto const canonical = [](uintX_t const &fp) {
+    return window_type::canonicalize(fp);
+  };
+
+  std::string s = std::string("ALGEBRA-") + std::to_string(w.bits());
+  bool correct = true;
+  for (uint64_t k = 0; k < 200; ++k) {
+    auto const a = piece((k % 2 == 0) ? 64 : 10000);
+    auto const b = piece((k % 4 < 2) ? 64 : 10000);
+    std::vector<uint8_t> ab = a;
+    ab.insert(ab.end(), b.begin(), b.end());
+    uintX_t const fp_a = direct(a);
+    uintX_t const fp_b = direct(b);
+    uintX_t const fp_ab = direct(ab);
+    correct &= (canonical(algebra.concat(fp_a, fp_b, b.size())) == fp_ab);
+    correct &= (canonical(algebra.strip_prefix(fp_ab, fp_a, b.size())) == fp_b);
+    correct &= (canonical(algebra.strip_suffix(fp_ab, fp_b, b.size())) == fp_a);
+
+    auto const r = piece(600);
+    std::vector<uint8_t> rk;
+    for (uint64_t const times : {0, 1, 2, 3, 7, 16}) {
+      while (rk.size() < times * r.size()) {
+        rk.insert(rk.end(), r.begin(), r.end());
+      }
+      correct &= (canonical(algebra.repeat(direct(r), r.size(), times)) ==
+                  direct(rk));
+    }
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+template <typename window_type, typename strong_window_type>
+KRINLNFN void mainp_chunking(std::span<uint8_t const> const string,
+                             window_type const &w,
+                             strong_window_type const &strong) {
+  auto const params = chunking_parameters::from_sizes(2048, 8192, 65536);
+  chunker<window_type, strong_window_type> const c(w, strong, params);
+
+  std::string s = std::string("CDC-") + std::to_string(w.bits()) + "-" +
+                  std::to_string(strong.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  uint64_t covered = 0;
+  uint64_t const chunks = c.chunk_text(
+      string, [&](auto const &chunk) { covered += chunk.length; });
+  auto time = timer.stop();
+  std::cout << s << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, string.size()) << "mibs" << std::endl;
+  std::cout << s << " chunks: " << chunks
+            << " avg size: " << (chunks ? string.size() / chunks : 0)
+            << std::endl;
+  std::cout << s << " correct=" << (covered == string.size()) << std::endl;
+}
+
+// dedup table of window fingerprints: flat set vs std::unordered_set
+template <typename window_type>
+KRINLNFN void mainp_hash(std::span<uint8_t const> const string,
+                         window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  uint64_t const tau = w.window_size();
+  if (string.size() < tau) return;
+  uint64_t const windows =
+      std::min<uint64_t>(string.size() - tau + 1, 1ULL << 23);
+  std::vector<uintX_t> fps(windows);
+  fingerprint_windows(w, string.first(windows + tau - 1),
+                      std::span<uintX_t>(fps));
+
+  auto const run = [&](std::string const &s, auto &set) {
+    std::cout << s << " start!" << std::endl;
+    timer.start();
+    for (auto const &fp : fps) set.insert(fp);
+    auto time = timer.stop();
+    std::cout << s << " insert time: " << time << "[ms]" << std::endl;
+    timer.start();
+    uint64_t found = 0;
+    for (auto const &fp : fps) found += set.contains(fp);
+    time = timer.stop();
+    std::cout << s << " lookup time: " << time << "[ms]" << std::endl;
+    return found + set.size();
+  };
+
+  std::string const bits = std::to_string(w.bits());
+  flat_fingerprint_set<uintX_t> flat;
+  uint64_t const a = run("HASH-FLAT-" + bits, flat);
+  std::unordered_set<uintX_t, fingerprint_hash<uintX_t>> std_set;
+  uint64_t const b = run("HASH-STD-" + bits, std_set);
+  std::cout << "HASH-" << bits << " distinct: " << flat.size()
+            << " correct=" << (a == b) << std::endl;
+}
+
+// fingerprints of all 4 KiB pages: one byte vs k bytes per step
+template <uint64_t k, typename window_type>
+KRINLNFN void mainp_stride(std::span<uint8_t const> const string,
+                           window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  constexpr uint64_t page = 4096;
+  uint64_t const pages = string.size() / page;
+  strided_window<window_type, k> const sw(w);
+  std::vector<uintX_t> bytewise(pages);
+  std::vector<uintX_t> strided(pages);
+
+  std::string s = std::string("PAGES-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  for (uint64_t p = 0; p < pages; ++p) {
+    uintX_t fp = uintX_t();
+    for (uint64_t i = p * page; i < (p + 1) * page; ++i) {
+      fp = w.roll_right(fp, string[i]);
+    }
+    bytewise[p] = fp;
+  }
+  auto time = timer.stop();
+  std::cout << s << " bytewise time: " << time << "[ms]"
+            << " = " << timer.mibs(time, pages * page) << "mibs" << std::endl;
+  timer.start();
+  for (uint64_t p = 0; p < pages; ++p) {
+    strided[p] = sw.fingerprint(string.subspan(p * page, page));
+  }
+  time = timer.stop();
+  std::cout << s << " stride-" << k << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, pages * page) << "mibs" << std::endl;
+  std::cout << s << " correct=" << (bytewise == strided) << std::endl;
+
+  // every window of a 64 KiB prefix slid by k bytes per step vs its
+  // fingerprint from scratch
+  uint64_t const tau = w.window_size();
+  uint64_t const n = std::min<uint64_t>(string.size(), 64 << 10);
+  uint8_t const *const t = string.data();
+  bool rolled = true;
+  if (n >= tau) {
+    uintX_t fp = sw.fingerprint(string.first(tau));
+    for (uint64_t i = 0; i + k + tau <= n; i += k) {
+      fp = sw.roll_right(fp, t + i, t + i + tau);
+      rolled &= (window_type::canonicalize(fp) ==
+                 window_type::canonicalize(
+                     sw.fingerprint(string.subspan(i + k, tau))));
+    }
+  }
+  std::cout << "ROLL-STRIDE-" << k << "-" << w.bits() << " correct=" << rolled
+            << std::endl;
+}
+
+// short keys of 8 to 256 bytes cut from the input: one key after the other
+// vs batches of independent keys
+template <typename window_type>
+KRINLNFN void mainp_batch(std::span<uint8_t const> const string,
+                          window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  std::mt19937_64 g(7);
+  std::vector<uint64_t> offsets = {0};
+  while (offsets.back() + 256 <= string.size()) {
+    offsets.push_back(offsets.back() + 8 + g() % 249);
+  }
+  uint64_t const n = offsets.size() - 1;
+  uint64_t const bytes = offsets.back();
+  batch_fingerprinter<window_type> const bf(w);
+  std::vector<uint8_t> scratch(bf.scratch_size(256));
+  std::vector<uintX_t> single(n);
+  std::vector<uintX_t> batched(n);
+
+  std::string s = std::string("KEYS-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  for (uint64_t i = 0; i < n; ++i) {
+    uintX_t fp = uintX_t();
+    for (uint64_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+      fp = w.roll_right(fp, string[j]);
+    }
+    single[i] = fp;
+  }
+  auto time = timer.stop();
+  std::cout << s << " single time: " << time << "[ms]"
+            << " = " << timer.mibs(time, bytes) << "mibs" << std::endl;
+  timer.start();
+  bf.fingerprint(string.first(bytes), offsets, batched, scratch);
+  time = timer.stop();
+  std::cout << s << " batch-" << bf.batch_size << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, bytes) << "mibs" << std::endl;
+  std::cout << s << " correct=" << (single == batched) << std::endl;
+
+  // the smallest scratch buffer, one row per pass, for both interfaces; a
+  // smaller one throws
+  std::vector<uint8_t> row(bf.scratch_size(0));
+  std::vector<uintX_t> rowwise(n);
+  bf.fingerprint(string.first(bytes), offsets, rowwise, row);
+  bool correct = (rowwise == single);
+  std::vector<std::span<uint8_t const>> keys;
+  for (uint64_t i = 0; i < n; ++i) {
+    keys.push_back(string.subspan(offsets[i], offsets[i + 1] - offsets[i]));
+  }
+  std::fill(rowwise.begin(), rowwise.end(), uintX_t());
+  bf.fingerprint(keys, rowwise, row);
+  correct &= (rowwise == single);
+  try {
+    bf.fingerprint(keys, rowwise,
+                   std::span<uint8_t>(row).first(row.size() - 1));
+    correct = false;
+  } catch (std::invalid_argument const &) {
+  }
+  std::cout << s << " scratch-" << row.size() << " correct=" << correct
+            << std::endl;
+}
+
+// sliding the window leftward over the whole input, from the last window to
+// the first one, then growing and shrinking the first window
+template <typename window_type>
+KRINLNFN void mainp_variable(std::span<uint8_t const> const string,
+                             window_type const &w) {
+  uint64_t const n = string.size();
+  uint64_t const tau = w.window_size();
+  using uintX_t = window_type::fingerprint_type;
+  variable_window<window_type> const vw(w);
+
+  uintX_t last = uintX_t();
+  for (size_t i = n - tau; i < n; i++) last = w.roll_right(last, string[i]);
+  uintX_t first = uintX_t();
+  for (size_t i = 0; i < tau; i++) first = w.roll_right(first, string[i]);
+
+  std::string s = std::string("FP-LEFT-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  uintX_t fp = last;
+  for (size_t i = n - tau; i > 0; i--) {
+    fp = vw.roll_left(fp, string[i - 1 + tau], string[i - 1]);
+  }
+  auto time = timer.stop();
+  std::cout << s << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, n) << "mibs" << std::endl;
+  bool correct = (fp == first);
+
+  // first window -> string[1, tau + 1) -> string[0, tau + 1) -> first window
+  fp = vw.push_right(vw.pop_left(fp, tau, string[0]), string[tau]);
+  fp = vw.pop_right(vw.push_left(fp, tau, string[0]), string[tau]);
+  correct = correct && (w.canonicalize(fp) == w.canonicalize(first));
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// minimizers of runs of w windows: fused with the rolling vs materializing
+// all fingerprints and scanning every run (on a prefix of 16 MiB)
+template <typename window_type>
+KRINLNFN void mainp_minimizers(std::span<uint8_t const> const string,
+                               window_type const &w, uint64_t const run) {
+  using uintX_t = window_type::fingerprint_type;
+  auto const text = string.first(std::min<uint64_t>(string.size(), 16 << 20));
+  uint64_t const tau = w.window_size();
+  if (text.size() < tau + run) return;
+  minimizer_sampler<window_type> const sampler(w, run);
+  std::vector<minimizer<uintX_t>> fused;
+
+  std::string s = std::string("MINIMIZERS-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  sampler.sample(text, [&](auto const &m) { fused.push_back(m); });
+  auto time = timer.stop();
+  std::cout << s << " fused time: " << time << "[ms]"
+            << " = " << timer.mibs(time, text.size()) << "mibs"
+            << " minimizers: " << fused.size() << std::endl;
+
+  timer.start();
+  std::vector<uintX_t> fps(text.size() - tau + 1);
+  fingerprint_windows(w, text, std::span<uintX_t>(fps));
+  for (auto &fp : fps) fp = window_type::canonicalize(fp);
+  std::vector<uint64_t> naive;
+  for (uint64_t j = run - 1; j < fps.size(); ++j) {
+    uint64_t best = j + 1 - run;
+    for (uint64_t i = best + 1; i <= j; ++i) {
+      if (fps[i] < fps[best]) best = i;
+    }
+    if (naive.empty() || naive.back() != best) naive.push_back(best);
+  }
+  time = timer.stop();
+  std::cout << s << " materialized time: " << time << "[ms]"
+            << " = " << timer.mibs(time, text.size()) << "mibs" << std::endl;
+
+  bool correct = (fused.size() == naive.size());
+  for (uint64_t i = 0; correct && i < naive.size(); ++i) {
+    correct = (fused[i].position == naive[i]) &&
+              (fused[i].fingerprint == fps[naive[i]]);
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// std::sort of (tuple, position) entries with few distinct tuples, which
+// moves tuples between comparisons (the comparison operators of
+// kr_tuple::tuple used to read the lanes through uint128_t pointers, which
+// broke strict aliasing and corrupted the heap at -O2), against sorting the
+// lanes in the order of kr_tuple::tuple::operator<: pairs of lanes compare
+// as 128-bit integers (the higher lane first), pairs in increasing order
+template <uint64_t x>
+void mainp_tuple_sort() {
+  using tuple_type = kr_tuple::tuple<x>;
+  using lanes_type = std::array<uint64_t, x>;
+  struct entry {
+    tuple_type fingerprint;
+    uint64_t position;
+
+    KRINLNFN bool operator<(entry const &o) const {
+      if (fingerprint == o.fingerprint) return position < o.position;
+      return fingerprint < o.fingerprint;
+    }
+  };
+
+  std::mt19937_64 g(x);
+  std::vector<tuple_type> values(729);
+  for (auto &value : values) {
+    for (uint64_t z = 0; z < x; ++z) value.v[z] = u64::mod(g());
+  }
+  uint64_t const n = 150000;
+  std::vector<entry> entries(n);
+  std::vector<std::pair<lanes_type, uint64_t>> expected(n);
+  for (uint64_t i = 0; i < n; ++i) {
+    entries[i] = {values[g() % values.size()], i};
+    for (uint64_t z = 0; z < x; ++z) {
+      expected[i].first[z] =
+          entries[i].fingerprint.v[((z ^ 1) < x) ? (z ^ 1) : z];
+    }
+    expected[i].second = i;
+  }
+
+  std::sort(entries.begin(), entries.end());
+  std::sort(expected.begin(), expected.end());
+  bool correct = true;
+  for (uint64_t i = 0; i < n; ++i) {
+    correct &= (entries[i].position == expected[i].second);
+  }
+  std::cout << "TUPLE-SORT-" << x << " correct=" << correct << std::endl;
+}
+
+// MinHash sketches of all 64 KiB documents of the input, sequential vs
+// batched over all threads, and sketches of documents of zeros: the zero
+// window of "a" followed by tau zeros (held as p) is the one of tau zeros
+template <minhash_scheme scheme, typename window_type>
+KRINLNFN void mainp_minhash(std::span<uint8_t const> const string,
+                            window_type const &w, std::string const &text) {
+  constexpr uint64_t k = 128;
+  constexpr uint64_t size = 64 * 1024;
+  using sketcher_type = minhash_sketcher<window_type, k, scheme>;
+  using sketch_type = sketcher_type::sketch_type;
+  sketcher_type const sketcher(w);
+  std::string s = std::string("MINHASH-") + text + "-" +
+                  std::to_string(w.bits());
+
+  uint64_t const tau = w.window_size();
+  std::vector<uint8_t> zeros(tau + 1, 0);
+  zeros[0] = 'a';
+  std::span<uint8_t const> const both(zeros);
+  // {zero window}, {"a" window}, {zero window, "a" window}
+  sketch_type const z = sketcher.sketch(both.subspan(1));
+  sketch_type const a = sketcher.sketch(both.first(tau));
+  sketch_type const za = sketcher.sketch(both);
+  bool zero_correct = true;
+  if constexpr (scheme == minhash_scheme::bottom_k) {
+    zero_correct = (estimate_jaccard(z, za) == 0.5);
+  } else {
+    for (uint64_t j = 0; j < k; ++j) {
+      zero_correct &= (za.v[j] == std::min(z.v[j], a.v[j]));
+    }
+  }
+  std::cout << s << " zeros correct=" << zero_correct << std::endl;
+
+  std::vector<std::span<uint8_t const>> documents;
+  for (uint64_t i = 0; i + size <= string.size(); i += size) {
+    documents.push_back(string.subspan(i, size));
+  }
+  // inputs under 64 KiB have no document
+  if (documents.empty()) return;
+  std::vector<sketch_type> sequential(documents.size());
+  std::vector<sketch_type> batched(documents.size());
+
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  for (uint64_t i = 0; i < documents.size(); ++i) {
+    sequential[i] = sketcher.sketch(documents[i]);
+  }
+  auto time = timer.stop();
+  std::cout << s << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, documents.size() * size) << "mibs"
+            << std::endl;
+  timer.start();
+  sketcher.sketch_documents(documents, batched);
+  time = timer.stop();
+  std::cout << s << " batched time: " << time << "[ms]"
+            << " = " << timer.mibs(time, documents.size() * size) << "mibs"
+            << std::endl;
+
+  std::vector<double> estimates(documents.size());
+  timer.start();
+  for (uint64_t i = 0; i < 1000; ++i) {
+    estimate_jaccard(batched[i % batched.size()],
+                     std::span<sketch_type const>(batched),
+                     std::span<double>(estimates));
+  }
+  time = timer.stop();
+  std::cout << s << " 1000 x " << batched.size()
+            << " estimates time: " << time << "[ms]" << std::endl;
+
+  bool correct = true;
+  for (uint64_t i = 0; i < documents.size(); ++i) {
+    correct = correct &&
+              std::equal(sequential[i].v, sequential[i].v + k,
+                         batched[i].v) &&
+              estimate_jaccard(batched[i], batched[i]) == 1.0;
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// repeated windows of a 16 MiB prefix: repeat_finder (parallel radix sort)
+// vs std::sort of (canonical fingerprint, position) pairs; and of a text with
+// zero runs (zero windows held as 0 and as p), verified with 1 and 3 threads,
+// vs a map of the window contents
+template <typename window_type>
+KRINLNFN void mainp_repeats(std::span<uint8_t const> const string,
+                            window_type const &w) {
+  using uintX_t = window_type::fingerprint_type;
+  auto const text = string.first(std::min<uint64_t>(string.size(), 16 << 20));
+  uint64_t const tau = w.window_size();
+  if (text.size() < tau) return;
+  repeat_finder<window_type> const finder(w);
+
+  std::string s = std::string("REPEATS-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  uint64_t occurrences = 0;
+  uint64_t const groups = finder.find(
+      text, [&](uintX_t const &, std::span<uint64_t const> const positions) {
+        occurrences += positions.size();
+      });
+  auto time = timer.stop();
+  std::cout << s << " radix time: " << time << "[ms]"
+            << " = " << timer.mibs(time, text.size()) << "mibs"
+            << " repeats: " << groups << std::endl;
+
+  timer.start();
+  std::vector<std::pair<uintX_t, uint64_t>> pairs(text.size() - tau + 1);
+  auto fp = uintX_t();
+  for (uint64_t i = 0; i < tau; ++i) fp = w.roll_right(fp, text[i]);
+  pairs[0] = {window_type::canonicalize(fp), 0};
+  for (uint64_t i = 1; i < pairs.size(); ++i) {
+    fp = w.roll_right(fp, text[i - 1], text[i - 1 + tau]);
+    pairs[i] = {window_type::canonicalize(fp), i};
+  }
+  std::sort(pairs.begin(), pairs.end());
+  uint64_t sorted_groups = 0;
+  uint64_t sorted_occurrences = 0;
+  for (uint64_t b = 0, e; b < pairs.size(); b = e) {
+    for (e = b + 1; e < pairs.size() && pairs[e].first == pairs[b].first;) ++e;
+    if (e - b >= 2) {
+      ++sorted_groups;
+      sorted_occurrences += e - b;
+    }
+  }
+  time = timer.stop();
+  std::cout << s << " std::sort time: " << time << "[ms]"
+            << " = " << timer.mibs(time, text.size()) << "mibs" << std::endl;
+  std::cout << s << " correct="
+            << (groups == sorted_groups && occurrences == sorted_occurrences)
+            << std::endl;
+
+  std::vector<uint8_t> zeros;
+  std::mt19937_64 g(tau);
+  for (uint64_t k = 0; k < 64; ++k) {
+    zeros.insert(zeros.end(), tau + g() % tau, 0);
+    uint64_t const i = g() % text.size();
+    uint64_t const len = std::min<uint64_t>(g() % 4, text.size() - i);
+    zeros.insert(zeros.end(), text.begin() + i, text.begin() + i + len);
+  }
+  std::map<std::string, std::vector<uint64_t>> windows;
+  for (uint64_t i = 0; i + tau <= zeros.size(); ++i) {
+    windows[std::string(zeros.begin() + i, zeros.begin() + i + tau)]
+        .push_back(i);
+  }
+  std::vector<std::vector<uint64_t>> expected;
+  for (auto const &[window, positions] : windows) {
+    if (positions.size() >= 2) expected.push_back(positions);
+  }
+  std::sort(expected.begin(), expected.end());
+  bool correct = true;
+  for (uint64_t const threads : {1, 3}) {
+    std::vector<std::vector<uint64_t>> found;
+    repeat_finder<window_type>(w, true, threads)
+        .find(zeros, [&](uintX_t const &,
+                         std::span<uint64_t const> const positions) {
+          found.emplace_back(positions.begin(), positions.end());
+        });
+    std::sort(found.begin(), found.end());
+    correct &= (found == expected);
+  }
+  std::cout << s << " zeros correct=" << correct << std::endl;
+}
+
+// windows shared by lines: repeat_finder::find_shared (lines without their
+// '\n', after a preamble that belongs to no line) vs a map of the windows of
+// every line; the lines are overlapping pieces of the first 4 KiB
 template <uint64_t shift>
-KRINLNFN void mainp2(std::vector<uint8_t> const &string, uint64_t const tau) {
+KRINLNFN void mainp_shared(std::span<uint8_t const> const string,
+                           uint64_t const tau) {
+  using window_type = sliding_window_handle<shift>;
+  auto const head = string.first(std::min<uint64_t>(string.size(), 4096));
+  if (head.empty()) return;
+  std::mt19937_64 g(shift);
+  std::vector<uint8_t> text(head.begin(), head.begin() + head.size() / 2);
+  std::vector<uint64_t> begins;
+  std::vector<uint64_t> ends;
+  for (uint64_t k = 0; k < 400; ++k) {
+    uint64_t const i = g() % head.size();
+    uint64_t const len = std::min(g() % 64, head.size() - i);
+    begins.push_back(text.size());
+    text.insert(text.end(), head.begin() + i, head.begin() + i + len);
+    ends.push_back(text.size());
+    text.push_back('\n');
+  }
+
+  std::map<std::string, std::vector<uint64_t>> lines;
+  for (uint64_t d = 0; d < begins.size(); ++d) {
+    for (uint64_t i = begins[d]; i + tau <= ends[d]; ++i) {
+      auto &ids = lines[std::string(text.begin() + i, text.begin() + i + tau)];
+      if (ids.empty() || ids.back() != d) ids.push_back(d);
+    }
+  }
+  std::vector<std::vector<uint64_t>> expected;
+  for (auto const &[window, ids] : lines) {
+    if (ids.size() >= 2) expected.push_back(ids);
+  }
+
+  window_type const w(tau);
+  repeat_finder<window_type> const finder(w, true);
+  std::vector<std::vector<uint64_t>> found;
+  uint64_t const shared = finder.find_shared(
+      text, begins, ends,
+      [&](auto const &, std::span<uint64_t const> const ids) {
+        found.emplace_back(ids.begin(), ids.end());
+      });
+  std::sort(expected.begin(), expected.end());
+  std::sort(found.begin(), found.end());
+  std::cout << "SHARED-" << shift << " correct="
+            << (found == expected && shared == expected.size()) << std::endl;
+}
+
+// delta of the input with a few edits against the input: the ops have to
+// rebuild the edited input, and all but the edited blocks are copies
+template <typename window_type>
+KRINLNFN void mainp_delta(std::span<uint8_t const> const string,
+                          window_type const &w) {
+  auto const base = string.first(std::min<uint64_t>(string.size(), 64 << 20));
+  std::vector<uint8_t> input(base.begin(), base.end());
+  std::mt19937_64 g(0);
+  for (uint64_t e = 0; e < 64 && !input.empty(); ++e) {
+    uint64_t const p = g() % input.size();
+    if (e & 1) {
+      input.insert(input.begin() + p, (uint8_t)g());
+    } else {
+      input[p] ^= 1;
+    }
+  }
+  delta_encoder<window_type> encoder(w);
+
+  std::string s = std::string("DELTA-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  uint64_t const blocks = encoder.sign(base);
+  auto time = timer.stop();
+  std::cout << s << " sign time: " << time << "[ms]"
+            << " = " << timer.mibs(time, base.size()) << "mibs"
+            << " blocks: " << blocks << std::endl;
+
+  std::vector<uint8_t> rebuilt;
+  rebuilt.reserve(input.size());
+  uint64_t copied = 0;
+  timer.start();
+  uint64_t const ops = encoder.encode(
+      std::span<uint8_t const>(input), [&](delta::op const &op) {
+        if (op.type == delta::op_type::copy) {
+          rebuilt.insert(rebuilt.end(), base.begin() + op.offset,
+                         base.begin() + op.offset + op.length);
+          copied += op.length;
+        } else {
+          rebuilt.insert(rebuilt.end(), op.data.begin(), op.data.end());
+        }
+      });
+  time = timer.stop();
+  std::cout << s << " encode time: " << time << "[ms]"
+            << " = " << timer.mibs(time, input.size()) << "mibs"
+            << " ops: " << ops << " copied: " << copied << std::endl;
+  std::cout << s << " correct=" << (rebuilt == input) << std::endl;
+
+  // a base with a 1 MiB zero region between two non-zero blocks, against
+  // itself: the equal zero blocks extend the copy, which covers everything
+  // but a partial block at the end
+  uint64_t const tau = w.window_size();
+  std::vector<uint8_t> zeros(tau, 0xab);
+  zeros.insert(zeros.end(), 1 << 20, 0);
+  zeros.insert(zeros.end(), tau + tau / 2, 0xcd);
+  delta_encoder<window_type> zero_encoder(w);
+  zero_encoder.sign(std::span<uint8_t const>(zeros));
+  rebuilt.clear();
+  uint64_t copies = 0;
+  uint64_t const zero_ops = zero_encoder.encode(
+      std::span<uint8_t const>(zeros), [&](delta::op const &op) {
+        if (op.type == delta::op_type::copy) {
+          rebuilt.insert(rebuilt.end(), zeros.begin() + op.offset,
+                         zeros.begin() + op.offset + op.length);
+          ++copies;
+        } else {
+          rebuilt.insert(rebuilt.end(), op.data.begin(), op.data.end());
+        }
+      });
+  uint64_t const expected_ops = (zeros.size() % tau != 0) ? 2 : 1;
+  std::cout << s << " zero region ops: " << zero_ops << " correct="
+            << (rebuilt == zeros && copies == 1 && zero_ops == expected_ops)
+            << std::endl;
+}
+
+// 128-bit kernels: u128::mult_add vs the generic reference kernel, as a
+// dependent chain fp = b * fp + c over the whole input
+template <uint64_t shift>
+KRINLNFN void mainp_kernels(std::span<uint8_t const> const string) {
+  constexpr uint128_t p = (((uint128_t)1) << shift) - 1;
+  uint128_t const base = u128::random(1, p - 1);
+
+  std::string s = std::string("KERNEL-") + std::to_string(shift);
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  uint128_t fp = 0;
+  for (uint8_t const c : string) fp = u128::mult_add<p>(base, fp, c);
+  auto time = timer.stop();
+  std::cout << s << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, string.size()) << "mibs" << std::endl;
+  timer.start();
+  uint128_t fp_generic = 0;
+  for (uint8_t const c : string) {
+    fp_generic = u128::mult_add_generic<p>(base, fp_generic, c);
+  }
+  time = timer.stop();
+  std::cout << s << " generic time: " << time << "[ms]"
+            << " = " << timer.mibs(time, string.size()) << "mibs" << std::endl;
+  std::cout << s << " correct=" << (fp == fp_generic) << std::endl;
+}
+
+// rolling with lazy reduction, canonicalized once at the end
+template <typename window_type>
+KRINLNFN void mainp_lazy(std::span<uint8_t const> const string,
+                         window_type const &w) {
+  uint64_t const n = string.size();
+  uint64_t const tau = w.window_size();
+  using uintX_t = window_type::fingerprint_type;
+
+  std::string s = std::string("FP-LAZY-") + std::to_string(w.bits());
+  std::cout << s << " start!" << std::endl;
+  timer.start();
+  auto fp = uintX_t();
+  for (size_t i = 0; i < tau; i++) {
+    fp = w.roll_right_lazy(fp, string[i]);
+  }
+  for (size_t i = 0; i < n - tau; i++) {
+    fp = w.roll_right_lazy(fp, string[i], string[i + tau]);
+  }
+  fp = w.canonicalize(fp);
+  auto time = timer.stop();
+  std::cout << s << " time: " << time << "[ms]"
+            << " = " << timer.mibs(time, n) << "mibs" << std::endl;
+
+  uintX_t fptest = uintX_t();
+  for (size_t i = n - tau; i < n; i++) {
+    fptest = w.roll_right(fptest, string[i]);
+  }
+  std::cout << s << " correct=" << (w.canonicalize(fptest) == fp) << std::endl;
+}
+
+template <uint64_t shift>
+KRINLNFN void mainp2(std::span<uint8_t const> const string, uint64_t const tau) {
   auto base = kr_fingerprinting::u64::random(0, (1ULL << 19) - 1);
-  auto rk = herlez::rolling_hash::rk_prime<decltype(string.cbegin()), shift>(
-      string.cbegin(), tau, base);
+  auto rk = herlez::rolling_hash::rk_prime<decltype(string.begin()), shift>(
+      string.begin(), tau, base);
 
   size_t last_window_index = string.size() - tau;
 
@@ -143,62 +1298,423 @@ KRINLNFN void mainp2(std::vector<uint8_t> const &string, uint64_t const tau) {
   // std::cout << s << " hash: " << result << std::endl;
 
   auto rk_test =
-      herlez::rolling_hash::rk_prime<decltype(string.cbegin()), shift>(
-          string.cbegin() + last_window_index, tau, base);
+      herlez::rolling_hash::rk_prime<decltype(string.begin()), shift>(
+          string.begin() + last_window_index, tau, base);
   auto fp_test = rk_test.get_currect_fp();
   std::cout << s << " correct=" << (fp_test == fp) << std::endl;
 }
 
+// the lanes of sliding_window_multi61 (AVX2 kernel with
+// KR_FINGERPRINTING_SIMD_LANES, see kr_test_avx2) vs one scalar 61-bit
+// window per lane with the lane's base, on every window of a 16 MiB prefix
+template <uint64_t x, table_layout layout>
+KRINLNFN void mainp_lanes(std::span<uint8_t const> const string,
+                          uint64_t const tau, std::string const &name) {
+  auto const text = string.first(std::min<uint64_t>(string.size(), 16 << 20));
+  if (text.size() < tau) return;
+  kr_tuple::tuple<x> base;
+  for (uint64_t z = 0; z < x; ++z) base.v[z] = u64::random(1, u64::p61 - 1);
+  u64::sliding_window_multi61<x, layout> const w(tau, base);
+  std::vector<u64::basic_sliding_window61<layout>> lanes;
+  for (uint64_t z = 0; z < x; ++z) lanes.emplace_back(tau, base.v[z]);
+
+  std::string s = std::string("LANES-") + name + "-" + std::to_string(61 * x);
+#ifdef KR_FINGERPRINTING_AVX2
+  std::cout << s << " kernel: avx2" << std::endl;
+#else
+  std::cout << s << " kernel: scalar" << std::endl;
+#endif
+  kr_tuple::tuple<x> fp;
+  uint64_t lane_fps[x] = {};
+  auto const equal = [&]() {
+    bool e = true;
+    for (uint64_t z = 0; z < x; ++z) e &= (fp.v[z] == lane_fps[z]);
+    return e;
+  };
+  bool correct = true;
+  for (uint64_t i = 0; i < tau; ++i) {
+    fp = w.roll_right(fp, text[i]);
+    for (uint64_t z = 0; z < x; ++z) {
+      lane_fps[z] = lanes[z].roll_right(lane_fps[z], text[i]);
+    }
+    correct &= equal();
+  }
+  for (uint64_t i = tau; i < text.size(); ++i) {
+    fp = w.roll_right(fp, text[i - tau], text[i]);
+    for (uint64_t z = 0; z < x; ++z) {
+      lane_fps[z] = lanes[z].roll_right(lane_fps[z], text[i - tau], text[i]);
+    }
+    correct &= equal();
+  }
+#ifdef KR_FINGERPRINTING_AVX2
+  // the kernel on operands next to the bounds a, b < 2^61, c < 2^62
+  uint64_t const operands[] = {0, 1, (1ULL << 32) - 1, 1ULL << 32, u64::p61 - 1,
+                               u64::p61, (1ULL << 62) - 1};
+  for (uint64_t const a : operands) {
+    for (uint64_t const b : operands) {
+      for (uint64_t const c : operands) {
+        if (a > u64::p61 || b > u64::p61) continue;
+        uint64_t out[4];
+        _mm256_storeu_si256((__m256i *)out,
+                            u64::simd::mult_add(_mm256_set1_epi64x(a),
+                                                _mm256_set1_epi64x(b),
+                                                _mm256_set1_epi64x(c)));
+        correct &= (out[0] == u64::mod(((uint128_t)a) * b + c));
+      }
+    }
+  }
+#endif
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// (a * b + c) mod 2^shift - 1 by double-and-add, the reference for the
+// 128-bit kernels
+template <uint64_t shift>
+uint128_t mult_add_bitserial(uint128_t const a, uint128_t const b,
+                             uint128_t const c) {
+  constexpr uint128_t p = (((uint128_t)1) << shift) - 1;
+  auto const add = [](uint128_t const x, uint128_t const y) {
+    uint128_t const s = x + y;
+    return (s >= p) ? (s - p) : s;
+  };
+  uint128_t r = 0;
+  for (uint64_t i = shift; i-- > 0;) {
+    r = add(r, r);
+    if ((b >> i) & 1) r = add(r, a);
+  }
+  return add(r, c);
+}
+
+// u128::mult_add and the generic kernel vs the bit-serial reference on all
+// combinations of edge-case operands (limbs that are all ones, operands next
+// to the modulus; e.g. for p127 a = 2, b = p - 1, c = 2^64 - 1 carries from
+// the low 64 bits into the high half) and on 10^6 random operands
+template <uint64_t shift>
+void mainp_mult_add() {
+  constexpr uint128_t p = (((uint128_t)1) << shift) - 1;
+  constexpr uint128_t m64 = ~0ULL;
+  uint128_t const operands[] = {0,         1,       2,      m64 - 1, m64,
+                                m64 + 1,   p - m64, p >> 1, p - 2,   p - 1,
+                                (p >> 64) << 64};
+  std::string s = std::string("MULT-ADD-") + std::to_string(shift);
+  bool correct = true;
+  auto const check = [&](uint128_t const a, uint128_t const b,
+                         uint128_t const c) {
+    uint128_t const expected = mult_add_bitserial<shift>(a, b, c);
+    correct &= (u128::mult_add<p>(a, b, c) == expected);
+    correct &= (u128::mult_add_generic<p>(a, b, c) == expected);
+  };
+  for (uint128_t const a : operands) {
+    for (uint128_t const b : operands) {
+      for (uint128_t const c : operands) check(a, b, c);
+    }
+  }
+  for (uint64_t i = 0; i < 1000000; ++i) {
+    check(u128::random(0, p - 1), u128::random(0, p - 1),
+          u128::random(0, p - 1));
+  }
+  std::cout << s << " correct=" << correct << std::endl;
+}
+
+// table files: save_table and the std::istream constructor round trip, files
+// of other windows, truncated and corrupted files are rejected, and
+// shared_window with a directory saves the table (through a temporary that is
+// renamed), replaces a corrupted file, and shares the cache of shared_window
+// without a directory
+template <uint64_t shift, table_layout layout>
+void mainp_table_cache(std::span<uint8_t const> const string,
+                       uint64_t const tau) {
+  using window_type = sliding_window<shift, layout>;
+  using uintX_t = window_type::fingerprint_type;
+  auto const head = string.first(std::min<uint64_t>(string.size(), 4096));
+
+  auto const same = [&](window_type const &a, window_type const &b) {
+    if (a.base() != b.base() || a.window_size() != b.window_size())
+      return false;
+    uintX_t fa = uintX_t();
+    uintX_t fb = uintX_t();
+    for (uint64_t i = 0; i < head.size(); ++i) {
+      if (i < tau) {
+        fa = a.roll_right(fa, head[i]);
+        fb = b.roll_right(fb, head[i]);
+      } else {
+        fa = a.roll_right(fa, head[i - tau], head[i]);
+        fb = b.roll_right(fb, head[i - tau], head[i]);
+      }
+      if (fa != fb) return false;
+    }
+    return true;
+  };
+  auto const rejected = [](std::string const &file, uint64_t const size,
+                           uintX_t const &base) {
+    std::istringstream in(file);
+    try {
+      window_type const w(size, base, in);
+    } catch (std::runtime_error const &) {
+      return true;
+    }
+    return false;
+  };
+
+  window_type const w(tau);
+  std::ostringstream out;
+  w.save_table(out);
+  std::string const file = out.str();
+  bool correct = true;
+  {
+    std::istringstream in(file);
+    correct &= same(window_type(tau, w.base(), in), w);
+  }
+  correct &= !rejected(file, tau, w.base());
+  correct &= rejected(file, tau + 1, w.base());
+  correct &= rejected(file, tau, window_type(tau).base());
+  correct &= rejected(file.substr(0, file.size() - 1), tau, w.base());
+  // the entry for pop_left = 1, right after the row of pop_left = 0
+  std::string corrupted = file;
+  uint64_t const table_bytes =
+      file.size() - sizeof(table_io::header) - sizeof(uintX_t);
+  corrupted[file.size() - table_bytes + table_bytes / 256] ^= 1;
+  correct &= rejected(corrupted, tau, w.base());
+
+  char directory[] = "/tmp/kr_test_XXXXXX";
+  if (::mkdtemp(directory) == nullptr) {
+    std::cout << "TABLE-CACHE-" << shift << " correct=0" << std::endl;
+    return;
+  }
+  std::string const path =
+      table_cache::file_name<window_type>(directory, tau, w.base());
+  std::string const tmp = path + ".tmp" + std::to_string(::getpid());
+  auto const saved = [&]() {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  };
+  {
+    auto const cached = shared_window<window_type>(tau, w.base(), directory);
+    correct &= same(*cached, w);
+    correct &= (saved() == file) && !std::ifstream(tmp);
+    correct &= (shared_window<window_type>(tau, w.base()) == cached);
+    correct &= (shared_window<window_type>(tau, w.base(), directory) == cached);
+  }
+  {
+    std::ofstream(path, std::ios::binary) << corrupted;
+    auto const cached = shared_window<window_type>(tau, w.base(), directory);
+    correct &= same(*cached, w) && (saved() == file);
+  }
+  std::remove(path.c_str());
+  ::rmdir(directory);
+  std::cout << "TABLE-CACHE-" << shift << " correct=" << correct << std::endl;
+}
+
+// full (256x256) vs compact (256) lookup table
+template <uint64_t shift>
+void mainp_layouts(std::span<uint8_t const> const string, uint64_t const tau,
+                   std::string const &text) {
+  mainp(string, sliding_window_handle<shift>(tau), "FP-FULL-" + text + "-");
+  mainp(string, sliding_window_handle<shift, table_layout::compact>(tau),
+        "FP-COMPACT-" + text + "-");
+}
+
 int main(int argc, char *argv[]) {
   if (argc < 2) return -1;
   uint64_t const tau = std::stoi(argv[1]);
 
-  std::vector<uint8_t> string;
+  std::vector<uint8_t> generated;
+  std::optional<mapped_file> file;
+  std::span<uint8_t const> string;
 
   if (argc > 2) {
-    std::ifstream t(argv[2]);
-
-    t.seekg(0, std::ios::end);
-    string = std::vector<uint8_t>();
-    string.reserve(t.tellg());
-    t.seekg(0, std::ios::beg);
-
-    string.assign((std::istreambuf_iterator<char>(t)),
-                  std::istreambuf_iterator<char>());
-    std::cout << "String loaded: " << string.size() << std::endl;
+    // MAP_POPULATE, such that page faults are not part of the measurements
+    timer.start();
+    file.emplace(argv[2], true);
+    string = file->span();
+    auto time = timer.stop();
+    std::cout << "String mapped: " << string.size() << " in " << time << "[ms]"
+              << std::endl;
   } else {
     static std::random_device seed;
     static std::mt19937_64 g(10);
     static std::uniform_int_distribution<uint8_t> d(1, 255);
     uint64_t const n = 1ULL * 128 * 1024 * 1024;
-    string.resize(n);
+    generated.resize(n);
     for (size_t i = 0; i < n; ++i) {
-      string[i] = d(g);
+      generated[i] = d(g);
     }
+    string = generated;
     std::cout << "String generated." << std::endl;
   }
 
-  mainp(string, kr_fingerprinting::sliding_window<61>(tau));
-  mainp(string, kr_fingerprinting::sliding_window<122>(tau));
-  mainp(string, kr_fingerprinting::sliding_window<183>(tau));
-  mainp(string, kr_fingerprinting::sliding_window<244>(tau));
+  mainp(string, sliding_window_handle<61>(tau));
+  mainp(string, sliding_window_handle<122>(tau));
+  mainp(string, sliding_window_handle<183>(tau));
+  mainp(string, sliding_window_handle<244>(tau));
+
+  mainp(string, sliding_window_handle<89>(tau));
+  mainp(string, sliding_window_handle<107>(tau));
+  mainp(string, sliding_window_handle<127>(tau));
+
+  mainp_lazy(string, sliding_window_handle<61>(tau));
+  mainp_lazy(string, sliding_window_handle<122>(tau));
+  mainp_lazy(string, sliding_window_handle<183>(tau));
+  mainp_lazy(string, sliding_window_handle<244>(tau));
 
-  mainp(string, kr_fingerprinting::sliding_window<89>(tau));
-  mainp(string, kr_fingerprinting::sliding_window<107>(tau));
-  mainp(string, kr_fingerprinting::sliding_window<127>(tau));
+  mainp_lazy(string, sliding_window_handle<89>(tau));
+  mainp_lazy(string, sliding_window_handle<107>(tau));
+  mainp_lazy(string, sliding_window_handle<127>(tau));
 
-  mainp1(string, kr_fingerprinting::sliding_window<61>(tau));
-  mainp1(string, kr_fingerprinting::sliding_window<122>(tau));
-  mainp1(string, kr_fingerprinting::sliding_window<183>(tau));
-  mainp1(string, kr_fingerprinting::sliding_window<244>(tau));
+  mainp1(string, sliding_window_handle<61>(tau).window());
+  mainp1(string, sliding_window_handle<122>(tau).window());
+  mainp1(string, sliding_window_handle<183>(tau).window());
+  mainp1(string, sliding_window_handle<244>(tau).window());
 
-  mainp1(string, kr_fingerprinting::sliding_window<89>(tau));
-  mainp1(string, kr_fingerprinting::sliding_window<107>(tau));
-  mainp1(string, kr_fingerprinting::sliding_window<127>(tau));
+  mainp1(string, sliding_window_handle<89>(tau).window());
+  mainp1(string, sliding_window_handle<107>(tau).window());
+  mainp1(string, sliding_window_handle<127>(tau).window());
 
   mainp2<61>(string, tau);
   mainp2<89>(string, tau);
   mainp2<107>(string, tau);
 
+  mainp_lanes<2, table_layout::full>(string, tau, "FULL");
+  mainp_lanes<3, table_layout::full>(string, tau, "FULL");
+  mainp_lanes<4, table_layout::full>(string, tau, "FULL");
+  mainp_lanes<3, table_layout::compact>(string, tau, "COMPACT");
+
+  mainp_kernels<89>(string);
+  mainp_kernels<107>(string);
+  mainp_kernels<127>(string);
+  mainp_mult_add<89>();
+  mainp_mult_add<107>();
+  mainp_mult_add<127>();
+
+  mainp_bulk(string, sliding_window_handle<61>(tau));
+  mainp_bulk(string, sliding_window_handle<122>(tau));
+  mainp_bulk(string, sliding_window_handle<183>(tau));
+  mainp_bulk(string, sliding_window_handle<244>(tau));
+
+  mainp_bulk(string, sliding_window_handle<89>(tau));
+  mainp_bulk(string, sliding_window_handle<107>(tau));
+  mainp_bulk(string, sliding_window_handle<127>(tau));
+
+  mainp_parallel(string, sliding_window_handle<61>(tau));
+  mainp_parallel(string, sliding_window_handle<122>(tau));
+  mainp_parallel(string, sliding_window_handle<127>(tau));
+
+  mainp_multi_length<61>(string);
+  mainp_multi_length<122>(string);
+  mainp_multi_length<127>(string);
+
+  mainp_patterns(string, sliding_window_handle<61>(tau));
+  mainp_patterns(string, sliding_window_handle<122>(tau));
+  mainp_patterns(string, sliding_window_handle<127>(tau));
+
+  mainp_stream(string, sliding_window_handle<61>(tau));
+  mainp_stream(string, sliding_window_handle<127>(tau));
+
+  mainp_parallel_prefix(string, sliding_window_handle<61>(tau));
+  mainp_parallel_prefix(string, sliding_window_handle<183>(tau));
+  mainp_parallel_prefix(string, sliding_window_handle<89>(tau));
+
+  mainp_prefix_index(string, sliding_window_handle<61>(tau));
+  mainp_prefix_index(string, sliding_window_handle<122>(tau));
+  mainp_prefix_index(string, sliding_window_handle<127>(tau));
+
+  mainp_algebra(string, sliding_window_handle<61>(tau));
+  mainp_algebra(string, sliding_window_handle<122>(tau));
+  mainp_algebra(string, sliding_window_handle<107>(tau));
+
+  {
+    auto const w = compact_sliding_window<61>(tau);
+    mainp_chunking(string, w, w);
+    mainp_chunking(string, w, compact_sliding_window<122>(tau));
+    mainp_chunking(string, w, compact_sliding_window<244>(tau));
+  }
+
+  mainp_hash(string, sliding_window_handle<61>(tau));
+  mainp_hash(string, sliding_window_handle<122>(tau));
+  mainp_hash(string, sliding_window_handle<244>(tau));
+  mainp_hash(string, sliding_window_handle<127>(tau));
+
+  mainp_stride<8>(string, sliding_window_handle<61>(tau));
+  mainp_stride<8>(string, sliding_window_handle<122>(tau));
+  mainp_stride<4>(string, sliding_window_handle<183>(tau));
+  mainp_stride<8>(string, sliding_window_handle<244>(tau));
+  mainp_stride<2>(string, sliding_window_handle<89>(tau));
+  mainp_stride<2>(string, sliding_window_handle<107>(tau));
+  mainp_stride<2>(string, sliding_window_handle<127>(tau));
+
+  mainp_batch(string, sliding_window_handle<61>(tau));
+  mainp_batch(string, sliding_window_handle<122>(tau));
+  mainp_batch(string, sliding_window_handle<183>(tau));
+  mainp_batch(string, sliding_window_handle<244>(tau));
+  mainp_batch(string, sliding_window_handle<89>(tau));
+  mainp_batch(string, sliding_window_handle<107>(tau));
+  mainp_batch(string, sliding_window_handle<127>(tau));
+
+  mainp_variable(string, sliding_window_handle<61>(tau));
+  mainp_variable(string, sliding_window_handle<122>(tau));
+  mainp_variable(string, sliding_window_handle<183>(tau));
+  mainp_variable(string, sliding_window_handle<244>(tau));
+  mainp_variable(string, sliding_window_handle<89>(tau));
+  mainp_variable(string, sliding_window_handle<107>(tau));
+  mainp_variable(string, sliding_window_handle<127>(tau));
+
+  mainp_minimizers(string, sliding_window_handle<61>(tau), 16);
+  mainp_minimizers(string, sliding_window_handle<122>(tau), 16);
+  mainp_minimizers(string, sliding_window_handle<244>(tau), 16);
+  mainp_minimizers(string, sliding_window_handle<127>(tau), 16);
+
+  mainp_tuple_sort<2>();
+  mainp_tuple_sort<3>();
+  mainp_tuple_sort<4>();
+
+  mainp_minhash<minhash_scheme::bottom_k>(string, sliding_window_handle<61>(tau),
+                                          "BOTTOMK");
+  mainp_minhash<minhash_scheme::k_permutation>(
+      string, sliding_window_handle<61>(tau), "KPERM");
+
+  mainp_repeats(string, sliding_window_handle<61>(tau));
+  mainp_repeats(string, sliding_window_handle<122>(tau));
+  mainp_repeats(string, sliding_window_handle<244>(tau));
+  mainp_repeats(string, sliding_window_handle<127>(tau));
+  mainp_shared<61>(string, 8);
+  mainp_shared<127>(string, 8);
+
+  mainp_delta(string, sliding_window_handle<61>(tau));
+  mainp_delta(string, sliding_window_handle<122>(tau));
+  mainp_delta(string, sliding_window_handle<127>(tau));
+
+  mainp_table_cache<61, table_layout::full>(string, tau);
+  mainp_table_cache<122, table_layout::compact>(string, tau);
+  mainp_table_cache<127, table_layout::compact>(string, tau);
+
+  mainp_layouts<61>(string, tau, "INPUT");
+  mainp_layouts<122>(string, tau, "INPUT");
+  mainp_layouts<183>(string, tau, "INPUT");
+  mainp_layouts<244>(string, tau, "INPUT");
+  mainp_layouts<89>(string, tau, "INPUT");
+  mainp_layouts<107>(string, tau, "INPUT");
+  mainp_layouts<127>(string, tau, "INPUT");
+
+  {
+    // low entropy text (alphabet ACGT), only few distinct table entries are hot
+    static std::mt19937_64 g(10);
+    static std::uniform_int_distribution<uint8_t> d(0, 3);
+    constexpr uint8_t acgt[4] = {'A', 'C', 'G', 'T'};
+    generated.resize(string.size());
+    for (size_t i = 0; i < generated.size(); ++i) {
+      generated[i] = acgt[d(g)];
+    }
+    string = generated;
+    std::cout << "Low entropy string generated." << std::endl;
+  }
+
+  mainp_layouts<61>(string, tau, "ACGT");
+  mainp_layouts<122>(string, tau, "ACGT");
+  mainp_layouts<183>(string, tau, "ACGT");
+  mainp_layouts<244>(string, tau, "ACGT");
+  mainp_layouts<89>(string, tau, "ACGT");
+  mainp_layouts<107>(string, tau, "ACGT");
+  mainp_layouts<127>(string, tau, "ACGT");
+
   return 0;
 }
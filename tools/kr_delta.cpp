@@ -0,0 +1,129 @@
+// Computes the delta of a new file against a base file with blocks of tau
+// bytes (rsync-style), streaming both files.
+//
+//   kr_delta [--tau=n] [--bits=61|122|183|244|89|107|127] [--ops] base new
+//
+// --ops prints one line per op, "copy" or "insert", the offset (in the base
+// for copies, in the new file for inserts) and the length, separated by
+// tabs. tau defaults to 4096. A summary goes to stderr.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include "../include/kr-delta.hpp"
+#include "../include/kr-window-handle.hpp"
+
+using namespace kr_fingerprinting;
+
+namespace {
+
+struct options {
+  uint64_t tau = 4096;
+  uint64_t bits = 61;
+  bool ops = false;
+  std::string base;
+  std::string input;
+};
+
+options parse(int argc, char *argv[]) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    auto const value =
+        [&](std::string const &key) -> std::optional<std::string> {
+      if (arg.rfind(key + "=", 0) == 0) return arg.substr(key.size() + 1);
+      return std::nullopt;
+    };
+    if (auto v = value("--tau")) {
+      opts.tau = std::stoull(*v);
+    } else if (auto v = value("--bits")) {
+      opts.bits = std::stoull(*v);
+    } else if (arg == "--ops") {
+      opts.ops = true;
+    } else if (arg.rfind("--", 0) != 0 && opts.base.empty()) {
+      opts.base = arg;
+    } else if (arg.rfind("--", 0) != 0 && opts.input.empty()) {
+      opts.input = arg;
+    } else {
+      throw std::invalid_argument("unknown argument: " + arg);
+    }
+  }
+  if (opts.tau == 0) throw std::invalid_argument("--tau must be positive");
+  if (opts.input.empty()) throw std::invalid_argument("missing paths");
+  return opts;
+}
+
+struct file {
+  int const fd;
+
+  explicit file(std::string const &path) : fd(::open(path.c_str(), O_RDONLY)) {
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+  }
+  ~file() { ::close(fd); }
+};
+
+template <typename window_type>
+void run(options const &opts) {
+  window_type const w(opts.tau);
+  delta_encoder<window_type> encoder(w);
+
+  auto const begin = std::chrono::steady_clock::now();
+  uint64_t blocks;
+  {
+    file const base(opts.base);
+    blocks = encoder.sign(stream::fd_reader{base.fd});
+  }
+  uint64_t copied = 0;
+  uint64_t inserted = 0;
+  file const input(opts.input);
+  uint64_t const ops = encoder.encode(
+      stream::fd_reader{input.fd}, [&](delta::op const &op) {
+        bool const copy = (op.type == delta::op_type::copy);
+        (copy ? copied : inserted) += op.length;
+        if (opts.ops) {
+          std::cout << (copy ? "copy" : "insert") << '\t' << op.offset << '\t'
+                    << op.length << '\n';
+        }
+      });
+  auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  std::cout.flush();
+  std::cerr << "blocks: " << blocks << " distinct: " << encoder.signatures()
+            << " tau: " << opts.tau << " bits: " << w.bits()
+            << " ops: " << ops << " copied: " << copied
+            << " inserted: " << inserted << " time: " << ms << "[ms]"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  try {
+    options const opts = parse(argc, argv);
+    switch (opts.bits) {
+      case 61: run<sliding_window_handle<61>>(opts); break;
+      case 122: run<sliding_window_handle<122>>(opts); break;
+      case 183: run<sliding_window_handle<183>>(opts); break;
+      case 244: run<sliding_window_handle<244>>(opts); break;
+      case 89: run<sliding_window_handle<89>>(opts); break;
+      case 107: run<sliding_window_handle<107>>(opts); break;
+      case 127: run<sliding_window_handle<127>>(opts); break;
+      default:
+        throw std::invalid_argument("unknown bits: " +
+                                    std::to_string(opts.bits));
+    }
+  } catch (std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+// Finds all repeated substrings of length tau in a file, or with
+// --documents all substrings shared by at least two lines of the file.
+//
+//   kr_repeats --tau=n [--bits=61|122|183|244|89|107|127] [--verify]
+//              [--threads=n] [--documents] [--limit=n] path
+//
+// Prints one line per repeat: the number of occurrences (or documents) and
+// up to --limit (default 8) of their positions (or line numbers, from 0),
+// separated by tabs. --verify compares the occurrences byte by byte, such
+// that fingerprint collisions are never reported. A summary goes to stderr.
+
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../include/kr-mmap.hpp"
+#include "../include/kr-repeats.hpp"
+#include "../include/kr-window-handle.hpp"
+
+using namespace kr_fingerprinting;
+
+namespace {
+
+struct options {
+  uint64_t tau = 0;
+  uint64_t bits = 61;
+  bool verify = false;
+  uint64_t threads = parallel::default_threads();
+  bool documents = false;
+  uint64_t limit = 8;
+  std::string path;
+};
+
+options parse(int argc, char *argv[]) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    auto const value =
+        [&](std::string const &key) -> std::optional<std::string> {
+      if (arg.rfind(key + "=", 0) == 0) return arg.substr(key.size() + 1);
+      return std::nullopt;
+    };
+    if (auto v = value("--tau")) {
+      opts.tau = std::stoull(*v);
+    } else if (auto v = value("--bits")) {
+      opts.bits = std::stoull(*v);
+    } else if (auto v = value("--threads")) {
+      opts.threads = std::max<uint64_t>(1, std::stoull(*v));
+    } else if (auto v = value("--limit")) {
+      opts.limit = std::stoull(*v);
+    } else if (arg == "--verify") {
+      opts.verify = true;
+    } else if (arg == "--documents") {
+      opts.documents = true;
+    } else if (arg.rfind("--", 0) != 0 && opts.path.empty()) {
+      opts.path = arg;
+    } else {
+      throw std::invalid_argument("unknown argument: " + arg);
+    }
+  }
+  if (opts.tau == 0) throw std::invalid_argument("missing --tau");
+  if (opts.path.empty()) throw std::invalid_argument("missing path");
+  return opts;
+}
+
+template <typename window_type>
+void run(options const &opts, std::span<uint8_t const> const text) {
+  window_type const w(opts.tau);
+  repeat_finder<window_type> const finder(w, opts.verify, opts.threads);
+
+  auto const print = [&](auto const &, std::span<uint64_t const> const ids) {
+    std::cout << ids.size();
+    for (uint64_t i = 0; i < std::min<uint64_t>(ids.size(), opts.limit); ++i) {
+      std::cout << '\t' << ids[i];
+    }
+    std::cout << '\n';
+  };
+
+  auto const begin = std::chrono::steady_clock::now();
+  uint64_t repeats;
+  if (opts.documents) {
+    // one document per line, without its '\n'
+    std::vector<uint64_t> begins = {0};
+    std::vector<uint64_t> ends;
+    for (uint64_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '\n') {
+        ends.push_back(i);
+        begins.push_back(i + 1);
+      }
+    }
+    if (begins.back() == text.size()) {
+      begins.pop_back();
+    } else {
+      ends.push_back(text.size());
+    }
+    repeats = finder.find_shared(text, begins, ends, print);
+  } else {
+    repeats = finder.find(text, print);
+  }
+  auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+  std::cout.flush();
+  std::cerr << "bytes: " << text.size() << " tau: " << opts.tau
+            << " bits: " << w.bits() << " repeats: " << repeats
+            << " time: " << ms << "[ms]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  try {
+    options const opts = parse(argc, argv);
+    mapped_file const file(opts.path, true);
+    auto const text = file.span();
+    switch (opts.bits) {
+      case 61: run<sliding_window_handle<61>>(opts, text); break;
+      case 122: run<sliding_window_handle<122>>(opts, text); break;
+      case 183: run<sliding_window_handle<183>>(opts, text); break;
+      case 244: run<sliding_window_handle<244>>(opts, text); break;
+      case 89: run<sliding_window_handle<89>>(opts, text); break;
+      case 107: run<sliding_window_handle<107>>(opts, text); break;
+      case 127: run<sliding_window_handle<127>>(opts, text); break;
+      default:
+        throw std::invalid_argument("unknown bits: " +
+                                    std::to_string(opts.bits));
+    }
+  } catch (std::exception const &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}